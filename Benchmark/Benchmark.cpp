@@ -0,0 +1,413 @@
+#include "Board.h"
+#include "BoardBatch.h"
+#include "Console.h"
+#include "Engine.h"
+#include "SaveFile.h"
+#include "SaveStore.h"
+#include "Simulator.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+
+// ------------- Harness -------------
+
+// Each benchmark runs its body in growing batches until one batch takes at
+// least minTime, then repeats that batch size and keeps the median, so the
+// numbers are comparable across commits on the same machine.
+
+#ifndef BENCH_BUILD_TYPE
+#define BENCH_BUILD_TYPE "unknown"
+#endif
+
+namespace {
+
+	//Keeps the optimizer from deleting work whose result is otherwise unused
+	template<class T>
+	void keep(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+		asm volatile("" : : "r,m"(value) : "memory");
+#else
+		static volatile char sink;
+		sink = *reinterpret_cast<const volatile char*>(&value);
+#endif
+	}
+
+	struct BenchResult {
+		string name;
+		string unit;		//What one operation is
+		uint64_t iterations = 0;
+		double nsPerOp = 0.0;
+		double opsPerSec = 0.0;
+	};
+
+	struct BenchOptions {
+		double minTime = 0.2;	//Seconds per measured batch
+		int repeats = 5;
+		string filter;
+		string jsonPath;		//"-" = stdout
+		bool quick = false;
+	};
+
+	using Clock = chrono::steady_clock;
+
+	//body(n) performs n operations; bodies that work in whole blocks get n as a multiple of block
+	BenchResult measure(const string& name, const string& unit, const BenchOptions& opt, const function<void(uint64_t)>& body,
+						uint64_t block) {
+		auto wholeBlocks = [&](uint64_t n) { return (n + block - 1) / block * block; };
+		uint64_t batch = wholeBlocks(1);
+		double seconds = 0.0;
+		for (;;) {
+			auto start = Clock::now();
+			body(batch);
+			seconds = chrono::duration<double>(Clock::now() - start).count();
+			if (seconds >= opt.minTime || batch >= (1ull << 40)) break;
+			batch = wholeBlocks((seconds <= 0.0) ? batch * 10 : max(batch * 2, static_cast<uint64_t>(batch * (opt.minTime * 1.2 / seconds))));
+		}
+
+		vector<double> samples{ seconds };
+		for (int r = 1; r < opt.repeats; ++r) {
+			auto start = Clock::now();
+			body(batch);
+			samples.push_back(chrono::duration<double>(Clock::now() - start).count());
+		}
+		sort(samples.begin(), samples.end());
+		double median = samples[samples.size() / 2];
+
+		BenchResult result;
+		result.name = name;
+		result.unit = unit;
+		result.iterations = batch * samples.size();
+		result.nsPerOp = median * 1e9 / static_cast<double>(batch);
+		result.opsPerSec = static_cast<double>(batch) / median;
+		return result;
+	}
+
+	//Measures unless --filter excludes it
+	void run(vector<BenchResult>& out, const string& name, const string& unit, const BenchOptions& opt, const function<void(uint64_t)>& body,
+			 uint64_t block = 1) {
+		if (!opt.filter.empty() && name.find(opt.filter) == string::npos) return;
+		out.push_back(measure(name, unit, opt, body, block));
+	}
+
+	//Boards from random partial games, wins and draws included
+	vector<Board> makeBoards(size_t count, uint64_t seed) {
+		Rng rng(seed, 0);
+		vector<Board> boards(count);
+		for (Board& b : boards) {
+			int moves = static_cast<int>(rng.below(10));
+			for (int m = 0; m < moves && !b.isFull(); ++m) {
+				b.set(randomEmptyCell(b, rng), (m % 2) ? 'O' : 'X');
+				if (b.hasWinner()) break;
+			}
+		}
+		return boards;
+	}
+
+	//Random placements on any board size until a mark completes a line through the cell just taken
+	template<class B>
+	int playRandomBoardGame(B& board, Rng& rng) {
+		array<int, B::cells> order;
+		for (int i = 0; i < B::cells; ++i) order[i] = i;
+		for (int i = B::cells - 1; i > 0; --i) swap(order[i], order[rng.below(static_cast<uint32_t>(i + 1))]);
+
+		board.clearBoard();
+		for (int t = 0; t < B::cells; ++t) {
+			board.set(order[t], (t % 2) ? 'O' : 'X');
+			if (board.winnerThrough(order[t]) != ' ') return t + 1;
+		}
+		return B::cells;
+	}
+}
+
+
+// ------------- Benchmarks -------------
+
+namespace {
+
+	void runBoardBenches(const BenchOptions& opt, vector<BenchResult>& out) {
+		vector<Board> boards = makeBoards(1024, 7);
+		const size_t mask = boards.size() - 1;
+
+		run(out, "board.winner", "call", opt, [&](uint64_t n) {
+			unsigned acc = 0;
+			for (uint64_t i = 0; i < n; ++i) acc += static_cast<unsigned char>(boards[i & mask].winner());
+			keep(acc);
+		});
+
+		run(out, "board.isFull", "call", opt, [&](uint64_t n) {
+			unsigned acc = 0;
+			for (uint64_t i = 0; i < n; ++i) acc += boards[i & mask].isFull();
+			keep(acc);
+		});
+
+		run(out, "board.countPlaced", "call", opt, [&](uint64_t n) {
+			unsigned acc = 0;
+			for (uint64_t i = 0; i < n; ++i) acc += boards[i & mask].countPlaced();
+			keep(acc);
+		});
+
+		run(out, "board.adjacentCells", "call", opt, [&](uint64_t n) {
+			unsigned acc = 0;
+			for (uint64_t i = 0; i < n; ++i) acc += adjacentCells(static_cast<int>(i % 9));
+			keep(acc);
+		});
+
+		run(out, "board.randomEmptyCell", "call", opt, [&](uint64_t n) {
+			Rng rng(11, 0);
+			int acc = 0;
+			for (uint64_t i = 0; i < n; ++i) {
+				const Board& b = boards[i & mask];
+				if (!b.isFull()) acc += randomEmptyCell(b, rng);
+			}
+			keep(acc);
+		});
+
+		//The larger variants, played to the end through the incremental line counters
+		auto randomGames = [&](auto board, const string& name) {
+			run(out, "board.randomGame." + name, "game", opt, [&](uint64_t n) {
+				Rng rng(13, 0);
+				int acc = 0;
+				for (uint64_t i = 0; i < n; ++i) acc += playRandomBoardGame(board, rng);
+				keep(acc);
+			});
+		};
+		randomGames(Board4x4(), "4x4");
+		randomGames(GomokuLiteBoard(), "5x5k4");
+		randomGames(FiveInARowBoard(), "15x15k5");
+
+		//Winner, full and placed for a whole block per call, every kernel this CPU has
+		BoardBatch batch;
+		for (const Board& b : boards) batch.push(b, 'X', 'O');
+		for (BatchKernel kernel : { BatchKernel::Scalar, BatchKernel::SSE2, BatchKernel::AVX2 }) {
+			if (!batchKernelSupported(kernel)) continue;
+			run(out, string("batch.evaluate.") + batchKernelName(kernel), "board", opt, [&](uint64_t n) {
+				for (uint64_t done = 0; done < n; done += batch.size()) batch.evaluate(kernel);
+				keep(batch.winner[0]);
+			}, batch.size());
+		}
+	}
+
+	void runInputBenches(const BenchOptions& opt, vector<BenchResult>& out) {
+		const vector<string> inputs = { "5", "a", " 9 ", "i", "10", "x", "7", "E", "", "3\r" };
+
+		run(out, "input.parseMove", "call", opt, [&](uint64_t n) {
+			int acc = 0;
+			for (uint64_t i = 0; i < n; ++i) acc += parseMove(inputs[i % inputs.size()]);
+			keep(acc);
+		});
+
+		//A batched script: one pushText per 1024 moves, then read back and parsed line by line
+		string script;
+		for (int i = 0; i < 1024; ++i) script += inputs[i % inputs.size()] + "\n";
+		run(out, "input.scriptFeed", "move", opt, [&](uint64_t n) {
+			InputChannel channel;
+			string line;
+			int acc = 0;
+			for (uint64_t done = 0; done < n; done += 1024) {
+				channel.pushText(script);
+				while (channel.tryRead(line) == InputStatus::Line) acc += parseMove(line);
+			}
+			keep(acc);
+		}, 1024);
+	}
+
+	void runGameBenches(const BenchOptions& opt, vector<BenchResult>& out) {
+		run(out, "game.randomRegular", "game", opt, [&](uint64_t n) {
+			Rng rngs[2] = { Rng(3, 0), Rng(3, 1) };
+			RandomController bots[2];
+			bots[0].rng = &rngs[0];
+			bots[1].rng = &rngs[1];
+
+			Player players[2];
+			players[0].name = "Player 1";
+			players[0].mark = 'X';
+			players[1].name = "Player 2";
+			players[1].mark = 'O';
+
+			int acc = 0;
+			for (uint64_t i = 0; i < n; ++i) {
+				TicTacToeGame game;
+				game.setPlayer(0, players[0], bots[0]);
+				game.setPlayer(1, players[1], bots[1]);
+				acc += game.run().turns;
+			}
+			keep(acc);
+		});
+
+		run(out, "game.campaignSimulation", "campaign", opt, [&](uint64_t n) {
+			SimulationConfig config;
+			int acc = 0;
+			for (uint64_t i = 0; i < n; ++i) {
+				acc += simulateCampaign(Archetype::Alchemist, config, static_cast<int>(i)).roundsPlayed;
+			}
+			keep(acc);
+		});
+	}
+
+	void runSaveBenches(const BenchOptions& opt, vector<BenchResult>& out) {
+		CampaignSaveData data;
+		data.hero.name = "Benchmark Hero";
+		data.hero.archetype = Archetype::Paladin;
+		data.hero.maxHP = 60;
+		data.hero.hp = 42;
+		data.hero.attack = 8;
+		data.hero.defense = 6;
+		data.stage = 5;
+		data.hasRng = true;
+		data.rng = Rng(5, 5);
+
+		run(out, "save.recordRoundTrip", "round trip", opt, [&](uint64_t n) {
+			CampaignSaveData back;
+			int acc = 0;
+			for (uint64_t i = 0; i < n; ++i) {
+				data.stage = static_cast<int>(i & 7);
+				SaveRecord record = makeSaveRecord(data);
+				if (isValidSaveRecord(record, sizeof(record))) readSaveRecord(record, back);
+				acc += back.stage;
+			}
+			keep(acc);
+		});
+
+		//Disk-bound: temp file + fsync + rename, then a checked read
+		string path = "bench_save.dat";
+		BenchOptions diskOpt = opt;
+		diskOpt.minTime = min(opt.minTime, 0.1);
+		run(out, "save.fileRoundTrip", "round trip", diskOpt, [&](uint64_t n) {
+			CampaignSaveData back;
+			int acc = 0;
+			for (uint64_t i = 0; i < n; ++i) {
+				writeCampaignSave(path, data);
+				acc += (readCampaignSave(path, back) == SaveStatus::Ok);
+			}
+			keep(acc);
+		});
+		remove(path.c_str());
+
+		string storePath = "bench_store.db";
+		remove(storePath.c_str());
+		SaveStore store;
+		if (store.open(storePath)) {
+			vector<string> names;
+			for (int i = 0; i < 1024; ++i) names.push_back("hero" + to_string(i));
+
+			run(out, "save.storeRoundTrip", "round trip", opt, [&](uint64_t n) {
+				CampaignSaveData back;
+				int acc = 0;
+				for (uint64_t i = 0; i < n; ++i) {
+					data.hero.name = names[i & 1023];
+					store.store(data);
+					acc += (store.load(data.hero.name, back) == SaveStatus::Ok);
+				}
+				keep(acc);
+			});
+			store.close();
+		}
+		remove(storePath.c_str());
+		remove((storePath + ".lock").c_str());
+	}
+}
+
+
+// ------------- Output -------------
+
+namespace {
+
+	string jsonEscape(const string& s) {
+		string out;
+		for (char c : s) {
+			if (c == '"' || c == '\\') out += '\\';
+			out += c;
+		}
+		return out;
+	}
+
+	//Fixed key order and one result per line, so two runs diff cleanly
+	void writeJson(ostream& os, const BenchOptions& opt, const vector<BenchResult>& results) {
+		os << "{\n";
+		os << "  \"schema\": 1,\n";
+		os << "  \"suite\": \"tictactoe\",\n";
+		os << "  \"build\": \"" << jsonEscape(BENCH_BUILD_TYPE) << "\",\n";
+		os << "  \"min_time_s\": " << opt.minTime << ",\n";
+		os << "  \"repeats\": " << opt.repeats << ",\n";
+		os << "  \"results\": [\n";
+		for (size_t i = 0; i < results.size(); ++i) {
+			const BenchResult& r = results[i];
+			os << "    {\"name\": \"" << jsonEscape(r.name) << "\", \"unit\": \"" << jsonEscape(r.unit)
+				<< "\", \"iterations\": " << r.iterations
+				<< fixed << setprecision(3) << ", \"ns_per_op\": " << r.nsPerOp
+				<< setprecision(1) << ", \"ops_per_sec\": " << r.opsPerSec << "}"
+				<< (i + 1 < results.size() ? "," : "") << "\n";
+			os << defaultfloat;
+		}
+		os << "  ]\n";
+		os << "}\n";
+	}
+
+	void writeTable(ostream& os, const vector<BenchResult>& results) {
+		os << left << setw(28) << "benchmark" << right << setw(14) << "ns/op" << setw(18) << "ops/s" << "  unit\n";
+		for (const BenchResult& r : results) {
+			os << left << setw(28) << r.name << right << fixed
+				<< setw(14) << setprecision(2) << r.nsPerOp
+				<< setw(18) << setprecision(0) << r.opsPerSec << "  " << r.unit << "\n";
+		}
+		os << defaultfloat;
+	}
+}
+
+
+// ------------- Main -------------
+
+int main(int argc, char* argv[]) {
+	BenchOptions opt;
+
+	for (int i = 1; i < argc; ++i) {
+		string arg = argv[i];
+		string value = (i + 1 < argc) ? argv[i + 1] : "";
+
+		//--json takes the next argument as its file unless that is another option
+		bool jsonFile = !value.empty() && value.compare(0, 2, "--") != 0;
+		if (arg == "--json") { opt.jsonPath = jsonFile ? value : "-"; if (jsonFile) ++i; }
+		else if (arg == "--filter" && !value.empty()) { opt.filter = value; ++i; }
+		else if (arg == "--min-time" && parseDouble(value, opt.minTime) && opt.minTime > 0) { ++i; }
+		else if (arg == "--repeats" && parseInt(value, opt.repeats, 1)) { ++i; }
+		else if (arg == "--quick") { opt.minTime = 0.02; opt.repeats = 1; }
+		else {
+			cerr << "Usage: Benchmark [--json [file|-]] [--filter substring] [--min-time seconds] [--repeats N] [--quick]\n";
+			return 1;
+		}
+	}
+
+	vector<BenchResult> results;
+	runBoardBenches(opt, results);
+	runInputBenches(opt, results);
+	runGameBenches(opt, results);
+	runSaveBenches(opt, results);
+
+	if (opt.jsonPath == "-") {
+		writeJson(cout, opt, results);
+	}
+	else {
+		writeTable(cout, results);
+		if (!opt.jsonPath.empty()) {
+			ofstream file(opt.jsonPath);
+			writeJson(file, opt, results);
+			if (!file) {
+				cerr << "Could not write " << opt.jsonPath << "\n";
+				return 1;
+			}
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,406 @@
+#include "Tests.h"
+
+#include "Board.h"
+#include "BoardBatch.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+
+namespace {
+
+	//The scan Board::winner replaced: first line in win_lines order held by one mark
+	char firstLineWinner(const Board& board) {
+		for (const auto& line : win_lines) {
+			char c = board.get(line[0]);
+			if (c != ' ' && c == board.get(line[1]) && c == board.get(line[2])) return c;
+		}
+		return ' ';
+	}
+
+	//K of mark in a row along any of the four directions, read cell by cell
+	template<class B>
+	bool holdsLine(const B& board, char mark) {
+		const int n = B::size, k = B::winLength;
+		const int dirs[4][2] = { { 0, 1 }, { 1, 0 }, { 1, 1 }, { 1, -1 } };
+		for (int r = 0; r < n; ++r) {
+			for (int c = 0; c < n; ++c) {
+				if (board.get(r * n + c) != mark) continue;
+				for (const auto& d : dirs) {
+					int run = 1;
+					while (run < k) {
+						int rr = r + d[0] * run, cc = c + d[1] * run;
+						if (rr < 0 || rr >= n || cc < 0 || cc >= n || board.get(rr * n + cc) != mark) break;
+						++run;
+					}
+					if (run == k) return true;
+				}
+			}
+		}
+		return false;
+	}
+
+	template<class B>
+	char scanWinner(const B& board) {
+		if (holdsLine(board, 'X')) return 'X';
+		if (holdsLine(board, 'O')) return 'O';
+		return ' ';
+	}
+
+	//Random placements in turn; the cell just taken is the only one that can complete a line
+	template<class B>
+	void checkRandomGames(int games, unsigned seed) {
+		mt19937 rng(seed);
+		B board;
+		vector<int> order(B::cells);
+		for (int g = 0; g < games; ++g) {
+			for (int i = 0; i < B::cells; ++i) order[i] = i;
+			shuffle(order.begin(), order.end(), rng);
+
+			board.clearBoard();
+			for (int t = 0; t < B::cells; ++t) {
+				board.set(order[t], (t % 2) ? 'O' : 'X');
+				char through = board.winnerThrough(order[t]);
+				CHECK_EQ(through, board.winner());
+				CHECK_EQ(through, scanWinner(board));
+				if (through != ' ') break;
+			}
+			CHECK(board.winner() != ' ' || board.isFull());
+		}
+	}
+
+	//Line count for N x N, K in a row, and every line K cells with one fixed step that never wraps a row
+	template<int N, int K>
+	void checkGeometry() {
+		using G = BoardGeometry<N, K>;
+		int expected = 2 * N * (N - K + 1) + 2 * (N - K + 1) * (N - K + 1);
+		CHECK_EQ(G::lineCount, expected);
+
+		for (const auto& line : G::lines) {
+			int dr = line[1] / N - line[0] / N, dc = line[1] % N - line[0] % N;
+			bool straight = (dr == 0 && dc == 1) || (dr == 1 && (dc == 0 || dc == 1 || dc == -1));
+			for (int i = 1; i < K; ++i) {
+				if (line[i] / N - line[i - 1] / N != dr || line[i] % N - line[i - 1] % N != dc) straight = false;
+			}
+			CHECK(straight);
+		}
+	}
+
+	//Sets, clears, swaps and shifts against a plain array of cells
+	template<class B>
+	void checkRandomEdits(int steps, unsigned seed) {
+		mt19937 rng(seed);
+		uniform_int_distribution<int> cell(0, B::cells - 1), pick(0, 5);
+		const char marks[3] = { ' ', 'X', 'O' };
+		B board;
+		vector<char> cells(B::cells, ' ');
+		for (int step = 0; step < steps; ++step) {
+			int a = cell(rng), b = cell(rng), roll = pick(rng);
+			if (roll < 3) {
+				board.set(a, marks[roll]);
+				cells[a] = marks[roll];
+			}
+			else if (roll == 3) {
+				board.swapCells(a, b);
+				swap(cells[a], cells[b]);
+			}
+			else {
+				board.moveCell(a, b);
+				if (cells[a] != ' ' && cells[b] == ' ') swap(cells[a], cells[b]);
+			}
+
+			bool x = holdsLine(board, 'X'), o = holdsLine(board, 'O');
+			int placed = static_cast<int>(cells.size()) - static_cast<int>(count(cells.begin(), cells.end(), ' '));
+			int wrong = 0;
+			for (int i = 0; i < B::cells; ++i) wrong += board.get(i) != cells[i];
+			CHECK_EQ(wrong, 0);
+			CHECK_EQ(board.hasWinner(), x || o);
+			CHECK_EQ(board.isDraw(), placed == B::cells && !x && !o);
+			CHECK_EQ(board.countPlaced(), placed);
+			char w = board.winner();
+			CHECK((w == 'X' && x) || (w == 'O' && o) || (w == ' ' && !x && !o));
+		}
+	}
+
+	//The hash from scratch, one key per held cell
+	template<class B>
+	uint64_t recomputeHash(const B& board) {
+		uint64_t h = 0;
+		for (int i = 0; i < B::cells; ++i) {
+			char c = board.get(i);
+			if (c != ' ') h ^= B::zobristKey(board.seatOf(c), i);
+		}
+		return h;
+	}
+
+	//Random sets, clears, swaps and shifts; the kept hash always matches the recomputed one,
+	//and two marks on the board never share a seat
+	template<class B>
+	void checkZobrist(int steps, unsigned seed, char first = 'X', char second = 'O') {
+		mt19937 rng(seed);
+		uniform_int_distribution<int> cell(0, B::cells - 1), pick(0, 4);
+		B board;
+		for (int step = 0; step < steps; ++step) {
+			int a = cell(rng), b = cell(rng);
+			switch (pick(rng)) {
+			case 0: board.set(a, first); break;
+			case 1: board.set(a, second); break;
+			case 2: board.set(a, ' '); break;
+			case 3: board.swapCells(a, b); break;
+			default: board.moveCell(a, b); break;
+			}
+			CHECK_EQ(board.hash(), recomputeHash(board));
+			int s0 = board.seatOf(first), s1 = board.seatOf(second);
+			CHECK(s0 == -1 || s1 == -1 || s0 != s1);
+		}
+	}
+
+	//Random sets and clears with two marks, so boards end up won, full, both or neither
+	void randomEdits(Board& board, mt19937& rng, char first, char second) {
+		uniform_int_distribution<int> cell(0, 8), pick(0, 3);
+		int edits = pick(rng) * 3;
+		for (int e = 0; e < edits; ++e) {
+			int roll = pick(rng);
+			board.set(cell(rng), roll == 0 ? ' ' : (roll % 2) ? first : second);
+		}
+	}
+}
+
+
+// ------------- Bitboard Board -------------
+
+TEST(board, matchesCellScan) {
+	mt19937 rng(1);
+	for (int i = 0; i < 20000; ++i) {
+		Board board;
+		randomEdits(board, rng, 'X', 'O');
+
+		int placed = 0;
+		Mask xs = 0, os = 0;
+		for (int c = 0; c < 9; ++c) {
+			char m = board.get(c);
+			if (m != ' ') ++placed;
+			if (m == 'X') xs |= cellBit(c);
+			if (m == 'O') os |= cellBit(c);
+		}
+		CHECK_EQ(board.winner(), firstLineWinner(board));
+		CHECK_EQ(board.countPlaced(), placed);
+		CHECK_EQ(board.isFull(), placed == 9);
+		CHECK_EQ(board.maskFor('X'), xs);
+		CHECK_EQ(board.maskFor('O'), os);
+		CHECK_EQ(board.occupiedMask(), static_cast<Mask>(xs | os));
+	}
+}
+
+TEST(board, customMarksReuseSlots) {
+	//Battle marks are any char; a slot is freed once its mark leaves the board
+	Board board;
+	board.set(0, '#');
+	board.set(4, '@');
+	board.set(8, '#');
+	CHECK_EQ(board.get(8), '#');
+	CHECK_EQ(board.maskFor('@'), cellBit(4));
+
+	board.set(4, ' ');
+	board.set(2, '$');
+	CHECK_EQ(board.get(2), '$');
+	CHECK_EQ(board.get(0), '#');
+	CHECK_EQ(board.maskFor('@'), Mask(0));
+
+	board.set(1, '#');
+	board.set(2, '#');
+	CHECK_EQ(board.winner(), '#');
+}
+
+TEST(board, thirdMarkIsRejected) {
+	Board board;
+	CHECK(board.set(0, 'X'));
+	CHECK(board.set(4, 'O'));
+	CHECK(board.set(8, 'X'));
+	uint64_t hash = board.hash();
+
+	//Both slots are taken: refused, nothing changes
+	CHECK(!board.set(2, '#'));
+	CHECK(!board.set(0, '#'));
+	CHECK_EQ(board.get(2), ' ');
+	CHECK_EQ(board.get(0), 'X');
+	CHECK_EQ(board.countPlaced(), 3);
+	CHECK_EQ(board.hash(), hash);
+
+	//Overwriting O's only cell frees its slot on the way
+	CHECK(board.set(4, '#'));
+	CHECK_EQ(board.get(4), '#');
+	CHECK_EQ(board.maskFor('O'), Mask(0));
+	CHECK(!board.set(1, 'O'));
+	CHECK(board.set(1, ' '));
+}
+
+
+// ------------- Lookup Tables -------------
+
+TEST(board, tablesMatchGeometry) {
+	for (int from = 0; from < 9; ++from) {
+		for (int to = 0; to < 9; ++to) {
+			int dr = from / 3 - to / 3, dc = from % 3 - to % 3;
+			bool next = from != to && -1 <= dr && dr <= 1 && -1 <= dc && dc <= 1;
+			CHECK_EQ(isAdjacent(from, to), next);
+		}
+	}
+
+	for (size_t l = 0; l < win_lines.size(); ++l) {
+		for (int cell = 0; cell < 9; ++cell) {
+			bool onLine = win_lines[l][0] == cell || win_lines[l][1] == cell || win_lines[l][2] == cell;
+			CHECK_EQ((cell_lines[cell] >> l) & 1, onLine ? 1 : 0);
+			CHECK_EQ((win_masks[l] & cellBit(cell)) != 0, onLine);
+		}
+	}
+}
+
+TEST(board, completesLineThroughEveryMask) {
+	for (unsigned m = 0; m < 512; ++m) {
+		Mask marks = static_cast<Mask>(m);
+		for (int cell = 0; cell < 9; ++cell) {
+			bool expected = false;
+			for (Mask line : win_masks) {
+				if ((line & cellBit(cell)) && (marks & line) == line) expected = true;
+			}
+			CHECK_EQ(completesLineThrough(marks, cell), expected);
+		}
+	}
+}
+
+
+// ------------- Board Sizes -------------
+
+TEST(board, geometryForEverySize) {
+	checkGeometry<3, 3>();
+	checkGeometry<4, 4>();
+	checkGeometry<5, 4>();
+	checkGeometry<15, 5>();
+}
+
+TEST(board, winnerThroughMatchesWinner) {
+	checkRandomGames<Board>(5000, 5);
+	checkRandomGames<Board4x4>(2000, 6);
+	checkRandomGames<GomokuLiteBoard>(2000, 7);
+	checkRandomGames<FiveInARowBoard>(200, 8);
+}
+
+TEST(board, lineCountsFollowEveryEdit) {
+	checkRandomEdits<Board>(50000, 9);
+	checkRandomEdits<Board4x4>(20000, 10);
+	checkRandomEdits<GomokuLiteBoard>(20000, 11);
+	checkRandomEdits<FiveInARowBoard>(3000, 12);
+}
+
+
+// ------------- Zobrist Hash -------------
+
+TEST(board, zobristMatchesRecompute) {
+	checkZobrist<Board>(20000, 13);
+	checkZobrist<GomokuLiteBoard>(20000, 14);
+	checkZobrist<FiveInARowBoard>(5000, 15);
+	checkZobrist<Board>(20000, 19, 'A', 'B');	//Undeclared marks
+}
+
+TEST(board, zobristIgnoresMoveOrder) {
+	//O placed first takes slot 0, the position still hashes the same
+	Board xFirst, oFirst;
+	xFirst.set(0, 'X');
+	xFirst.set(4, 'O');
+	oFirst.set(4, 'O');
+	oFirst.set(0, 'X');
+	CHECK_EQ(oFirst.hash(), xFirst.hash());
+	CHECK(xFirst.hash(1) != xFirst.hash(0));
+
+	//Clearing every X frees its slot; placing X again lands back on the same hash
+	oFirst.set(0, ' ');
+	oFirst.set(0, 'X');
+	CHECK_EQ(oFirst.hash(), xFirst.hash());
+
+	xFirst.set(0, ' ');
+	xFirst.set(4, ' ');
+	CHECK_EQ(xFirst.hash(), uint64_t(0));
+
+	FiveInARowBoard large;
+	large.set(224, 'O');
+	large.set(112, 'X');
+	CHECK_EQ(large.hash(), FiveInARowBoard::zobristKey(0, 112) ^ FiveInARowBoard::zobristKey(1, 224));
+}
+
+TEST(board, zobristKeysBySeat) {
+	Board plain, custom;
+	custom.setSeatMarks('#', '@');
+	const int cells[] = { 4, 0, 8, 2, 6 };
+	for (int t = 0; t < 5; ++t) plain.set(cells[t], (t % 2) ? 'O' : 'X');
+
+	//The second player's mark lands first, and it still hashes as seat 1
+	for (int t = 4; t >= 0; --t) custom.set(cells[t], (t % 2) ? '@' : '#');
+	CHECK_EQ(custom.hash(), plain.hash());
+	CHECK_EQ(custom.seatOf('@'), 1);
+
+	//The seat marks outlive a clear
+	custom.clearBoard();
+	custom.set(0, '@');
+	CHECK_EQ(custom.seatOf('@'), 1);
+	CHECK_EQ(custom.seatOf('#'), -1);
+}
+
+
+// ------------- Batch Evaluation -------------
+
+TEST(batch, kernelsMatchWinnerOf) {
+	mt19937 rng(16);
+	for (size_t count : { size_t(0), size_t(1), size_t(7), size_t(8), size_t(15), size_t(16), size_t(17), size_t(4099) }) {
+		//Two random disjoint masks, so some boards are won, full or both
+		vector<Mask> first(count), second(count);
+		vector<int8_t> expectedWinner(count);
+		for (size_t i = 0; i < count; ++i) {
+			Position p;
+			p.marks[0] = static_cast<Mask>(rng() & Board::fullMask);
+			p.marks[1] = static_cast<Mask>(rng() & Board::fullMask & ~p.marks[0]);
+			first[i] = p.marks[0];
+			second[i] = p.marks[1];
+			expectedWinner[i] = static_cast<int8_t>(winnerOf(p));
+		}
+
+		for (BatchKernel kernel : { BatchKernel::Scalar, BatchKernel::SSE2, BatchKernel::AVX2, BatchKernel::Auto }) {
+			if (!batchKernelSupported(kernel)) continue;
+			vector<int8_t> winner(count, 99);
+			vector<uint8_t> full(count, 99), placed(count, 99);
+			evaluateBoards(first.data(), second.data(), count, winner.data(), full.data(), placed.data(), kernel);
+
+			int mismatches = 0;
+			for (size_t i = 0; i < count; ++i) {
+				Mask occupied = static_cast<Mask>(first[i] | second[i]);
+				if (winner[i] != expectedWinner[i]
+					|| full[i] != (occupied == Board::fullMask)
+					|| placed[i] != popCount(occupied)) {
+					++mismatches;
+				}
+			}
+			CHECK_EQ(mismatches, 0);
+		}
+	}
+}
+
+TEST(batch, boardBatchMatchesBoards) {
+	mt19937 rng(17);
+	BoardBatch batch;
+	vector<Board> boards(300);
+	for (Board& b : boards) {
+		randomEdits(b, rng, 'X', 'O');
+		batch.push(b, 'X', 'O');
+	}
+	batch.evaluate();
+
+	for (size_t i = 0; i < boards.size(); ++i) {
+		char w = boards[i].winner();
+		CHECK_EQ(static_cast<int>(batch.winner[i]), (w == 'X') ? 0 : (w == 'O') ? 1 : -1);
+		CHECK_EQ(static_cast<bool>(batch.full[i]), boards[i].isFull());
+		CHECK_EQ(static_cast<int>(batch.placed[i]), boards[i].countPlaced());
+	}
+}
@@ -0,0 +1,249 @@
+#include "Tests.h"
+
+#include "Console.h"
+#include "Input.h"
+
+#include <cctype>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#if !defined(_WIN32)
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+
+namespace {
+
+	//The parser parseMove replaced: strip whitespace, one letter, else stoi over the whole rest
+	int referenceParseMove(const string& raw, int cells) {
+		string s;
+		for (unsigned char c : raw) {
+			if (!isspace(c)) s.push_back(static_cast<char>(c));
+		}
+		if (s.empty()) return -1;
+
+		if (s.size() == 1) {
+			char c = static_cast<char>(tolower(static_cast<unsigned char>(s[0])));
+			if (c >= 'a' && c < 'a' + cells && c <= 'z') return c - 'a';
+			if (isdigit(static_cast<unsigned char>(s[0]))) {
+				int n = s[0] - '0';
+				if (1 <= n && n <= cells) return n - 1;
+			}
+		}
+
+		try {
+			size_t pos = 0;
+			int n = stoi(s, &pos);
+			if (pos == s.size() && 1 <= n && n <= cells) return n - 1;
+		}
+		catch (...) {
+		}
+		return -1;
+	}
+}
+
+
+// ------------- Board Renderer -------------
+
+TEST(render, frameKeepsThePrintedLayout) {
+	Board board;
+	board.set(0, 'X');
+	board.set(4, 'O');
+	string frame;
+	board.formatBoard(frame);
+	CHECK_EQ(frame, string("\n X | 2 | 3\n-----------\n 4 | O | 6\n-----------\n 7 | 8 | 9\n\nEnter: 1-9 or a-i\n\n"));
+
+	FiveInARowBoard large;
+	frame.clear();
+	large.formatBoard(frame);
+	CHECK(frame.find("  1 |   2 |") != string::npos);
+	CHECK(frame.find("Enter: 1-225\n") != string::npos);
+}
+
+TEST(render, cellRangeFollowsTheBoard) {
+	string board, small, large;
+	Board::appendCellRange(board);
+	Board4x4::appendCellRange(small);
+	FiveInARowBoard::appendCellRange(large);
+	CHECK_EQ(board, string("1-9 or a-i"));
+	CHECK_EQ(small, string("1-16 or a-p"));
+	CHECK_EQ(large, string("1-225"));
+}
+
+TEST(render, fullAndOffModes) {
+	Board board;
+	board.set(8, 'X');
+	string frame;
+	board.formatBoard(frame);
+
+	ostringstream full, off;
+	{
+		BoardRenderer renderer(full, RenderMode::Full);
+		renderer.draw(board);
+		renderer.draw(board);
+		BoardRenderer silent(off, RenderMode::Off);
+		silent.draw(board);
+	}
+	CHECK_EQ(full.str(), frame + frame);
+	CHECK(off.str().empty());
+}
+
+TEST(render, diffRedrawsOnlyChangedCells) {
+	Board board;
+	ostringstream out;
+	BoardRenderer renderer(out, RenderMode::Diff);
+	renderer.draw(board);
+	size_t first = out.str().size();
+	CHECK(first > 0);
+
+	//Nothing changed, nothing sent
+	renderer.draw(board);
+	CHECK_EQ(out.str().size(), first);
+
+	//One cell: save cursor, move to row 4 column 6, the mark, restore
+	board.set(4, 'O');
+	renderer.draw(board);
+	CHECK_EQ(out.str().substr(first), string("\x1b" "7\x1b[4;6HO\x1b" "8"));
+
+	renderer.release();
+	CHECK(out.str().size() > first);
+}
+
+
+// ------------- Input Channel -------------
+
+TEST(input, channelKeepsOrderUntilClosed) {
+	InputChannel channel;
+	string line;
+	CHECK(channel.tryRead(line) == InputStatus::Timeout);
+	CHECK(channel.read(line, 1) == InputStatus::Timeout);
+
+	channel.push("first");
+	channel.push("second");
+	CHECK_EQ(channel.pending(), size_t(2));
+	channel.close();
+
+	CHECK(channel.read(line) == InputStatus::Line && line == "first");
+	CHECK(channel.tryRead(line) == InputStatus::Line && line == "second");
+	CHECK(channel.read(line) == InputStatus::Closed);
+}
+
+TEST(input, scriptsAndPipesFeedOneChannel) {
+	auto channel = make_shared<InputChannel>();
+	InputLoop loop;
+	loop.addScript({ "1", "b" }, channel);
+#if !defined(_WIN32)
+	int fds[2];
+	CHECK(pipe(fds) == 0);
+	const char text[] = "3\r\nlast";
+	CHECK(write(fds[1], text, sizeof(text) - 1) == static_cast<ssize_t>(sizeof(text) - 1));
+	close(fds[1]);
+	loop.addFd(fds[0], channel);
+#endif
+	loop.start();
+
+	string line;
+	vector<string> expected = { "1", "b" };
+#if !defined(_WIN32)
+	expected.push_back("3");
+	expected.push_back("last");
+#endif
+	for (const string& e : expected) {
+		CHECK(channel->read(line, 2000) == InputStatus::Line);
+		CHECK_EQ(line, e);
+	}
+	CHECK(channel->read(line, 2000) == InputStatus::Closed);
+	loop.stop();
+#if !defined(_WIN32)
+	close(fds[0]);
+#endif
+}
+
+#if !defined(_WIN32)
+
+TEST(input, scriptLoadsFromAPipe) {
+	//What the shell hands over for --script <(printf ...): a path that can't seek
+	int fds[2];
+	CHECK(pipe(fds) == 0);
+	const char text[] = "4\nb\n";
+	CHECK(write(fds[1], text, sizeof(text) - 1) == static_cast<ssize_t>(sizeof(text) - 1));
+	close(fds[1]);
+	CHECK(loadConsoleScript("/dev/fd/" + to_string(fds[0])));
+	close(fds[0]);
+	CHECK(!loadConsoleScript("no_such_script.txt"));
+
+	string line;
+	CHECK(consoleInput().tryRead(line) == InputStatus::Line && line == "4");
+	CHECK(consoleInput().tryRead(line) == InputStatus::Line && line == "b");
+}
+
+#endif
+
+TEST(input, pushTextSplitsLines) {
+	InputChannel channel;
+	channel.pushText("1\r\nb\n\nlast");
+	channel.close();
+
+	string line;
+	const char* expected[] = { "1", "b", "", "last" };
+	for (const char* e : expected) {
+		CHECK(channel.tryRead(line) == InputStatus::Line);
+		CHECK_EQ(line, string(e));
+	}
+	CHECK(channel.tryRead(line) == InputStatus::Closed);
+}
+
+
+// ------------- Move Parsing -------------
+
+TEST(input, parseMoveMatchesReference) {
+	const char alphabet[] = "0123456789+-aAiIjzZ x\t\r\n.";
+	mt19937 rng(18);
+	int mismatches = 0;
+	for (int i = 0; i < 200000; ++i) {
+		string raw;
+		int length = static_cast<int>(rng() % 7);
+		for (int k = 0; k < length; ++k) raw += alphabet[rng() % (sizeof(alphabet) - 1)];
+		int cells = (i % 3 == 0) ? 16 : 9;
+		if (parseMove(raw, cells) != referenceParseMove(raw, cells)) ++mismatches;
+	}
+	CHECK_EQ(mismatches, 0);
+
+	for (const string& raw : { string("99999999999999999999"), string("+5"), string("-1"), string(" 1 0 "), string("e"), string("") }) {
+		CHECK_EQ(parseMove(raw, 16), referenceParseMove(raw, 16));
+	}
+}
+
+TEST(input, parseMoveExamples) {
+	CHECK_EQ(parseMove("5"), 4);
+	CHECK_EQ(parseMove(" a "), 0);
+	CHECK_EQ(parseMove("I"), 8);
+	CHECK_EQ(parseMove("j"), -1);
+	CHECK_EQ(parseMove("10"), -1);
+	CHECK_EQ(parseMove("3\r"), 2);
+	CHECK_EQ(parseMove(""), -1);
+	CHECK_EQ(parseMove("225", 225), 224);
+}
+
+TEST(input, parseNumbers) {
+	int n = 7;
+	CHECK(parseInt("12", n) && n == 12);
+	CHECK(parseInt("-3", n, -5, 5) && n == -3);
+	for (const char* bad : { "", "abc", "12x", " 12", "+1", "99999999999" }) CHECK(!parseInt(bad, n));
+	CHECK(!parseInt("65", n, 1, 64));
+	CHECK_EQ(n, -3);	//Failures leave the value alone
+
+	uint64_t u = 0;
+	CHECK(parseUint64("18446744073709551615", u) && u == 18446744073709551615ull);
+	CHECK(!parseUint64("18446744073709551616", u));
+	CHECK(!parseUint64("-1", u));
+
+	double d = 0;
+	CHECK(parseDouble("2.5", d) && d == 2.5);
+	for (const char* bad : { "", "2.5ms", " 1", "inf", "nan", "1e999" }) CHECK(!parseDouble(bad, d));
+	CHECK_EQ(d, 2.5);
+}
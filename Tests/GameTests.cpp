@@ -0,0 +1,341 @@
+#include "Tests.h"
+
+#include "Replay.h"
+#include "SelfPlay.h"
+#include "Server.h"
+#include "Simulator.h"
+#include "Tournament.h"
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+
+namespace {
+
+	//Self-play's FNV-1a digest, rebuilt from the actions in a parsed log
+	uint64_t digestOf(const ReplayGame& game) {
+		uint64_t digest = fnvOffset;
+		for (const ReplayEvent& e : game.events) {
+			if (e.tag != ReplayTag::Action) continue;
+			uint64_t value = (static_cast<uint64_t>(e.seat) << 24) | (static_cast<uint64_t>(e.action.type) << 16)
+				| (static_cast<uint64_t>(static_cast<uint8_t>(e.action.a)) << 8) | static_cast<uint8_t>(e.action.b);
+			digest = fnvFold(digest, value);
+		}
+		return digest;
+	}
+
+	//Plays games with recording on, then replays every log against its outcome
+	void checkReplays(SelfPlayConfig config, int games) {
+		config.recordPath = "unused";	//playSelfPlayGame only keeps the log in the record
+		for (int i = 0; i < games; ++i) {
+			GameRecord record = playSelfPlayGame(config, i);
+
+			vector<ReplayGame> parsed;
+			CHECK(parseReplays(record.replay, parsed));
+			CHECK_EQ(parsed.size(), size_t(1));
+			if (parsed.size() != 1) continue;
+
+			ReplayResult replayed = replayGame(parsed[0]);
+			CHECK(replayed.matched);
+			if (config.mode == SelfPlayMode::Campaign) continue;
+
+			CHECK_EQ(digestOf(parsed[0]), record.digest);
+			CHECK_EQ(replayed.result, record.outcome.winnerSeat);
+			CHECK_EQ(replayed.length, record.outcome.turns);
+		}
+	}
+
+	//Runs a command-line entry point on the given arguments
+	int runCommand(int (*command)(int, char*[]), vector<string> args) {
+		vector<char*> argv;
+		for (string& a : args) argv.push_back(&a[0]);
+		return command(static_cast<int>(argv.size()), argv.data());
+	}
+
+	bool sameStats(const ArchetypeStats& a, const ArchetypeStats& b) {
+		return a.archetype == b.archetype && a.campaigns == b.campaigns && a.victories == b.victories
+			&& a.defeats == b.defeats && a.stalemates == b.stalemates && a.rounds == b.rounds
+			&& a.reached == b.reached && a.deaths == b.deaths && a.hpOnEntry == b.hpOnEntry && a.finalHP == b.finalHP;
+	}
+}
+
+
+// ------------- Replays -------------
+
+TEST(replay, regularGamesReproduce) {
+	SelfPlayConfig config;
+	config.bots[0] = BotKind::Random;
+	config.bots[1] = BotKind::Perfect;
+	checkReplays(config, 300);
+}
+
+TEST(replay, battleGamesReproduce) {
+	SelfPlayConfig config;
+	config.mode = SelfPlayMode::Battle;
+	config.bots[0] = BotKind::Search;
+	config.bots[1] = BotKind::Random;
+	config.searchDepth = 3;
+	checkReplays(config, 100);
+}
+
+TEST(replay, campaignsReproduce) {
+	SelfPlayConfig config;
+	config.mode = SelfPlayMode::Campaign;
+	config.bots[0] = BotKind::Perfect;
+	config.bots[1] = BotKind::Random;
+	checkReplays(config, 30);
+
+	//The MCTS enemy stops on its iteration count alone, so the replay runs the same search
+	config.bots[1] = BotKind::Mcts;
+	checkReplays(config, 2);
+}
+
+TEST(replay, tieredCampaignsReproduce) {
+	//Recorded the way a live campaign records, with alpha-beta enemies recomputed on replay
+	SimulationConfig config;
+	config.enemy = EnemyStrategy::Tiered;
+	config.seed = 12;
+	for (int i = 0; i < 40; ++i) {
+		ReplayWriter writer;
+		CampaignSummary live = simulateCampaign(Archetype::Alchemist, config, i, &writer);
+
+		vector<ReplayGame> parsed;
+		CHECK(parseReplays(writer.data(), parsed));
+		CHECK_EQ(parsed.size(), size_t(1));
+		if (parsed.size() != 1) continue;
+
+		ReplayResult replayed = replayGame(parsed[0]);
+		CHECK(replayed.matched);
+		CHECK_EQ(replayed.result, static_cast<int>(live.result));
+		CHECK_EQ(replayed.length, live.endStage);
+	}
+}
+
+TEST(replay, truncatedLogIsRejected) {
+	SelfPlayConfig config;
+	config.recordPath = "unused";
+	GameRecord record = playSelfPlayGame(config, 0);
+
+	vector<ReplayGame> parsed;
+	CHECK(!parseReplays(record.replay.substr(0, record.replay.size() - 1), parsed));
+	CHECK(!parseReplays("not a replay", parsed));
+}
+
+
+// ------------- Campaign Simulator -------------
+
+TEST(simulator, reportIgnoresThreadCount) {
+	SimulationConfig config;
+	config.campaigns = 600;
+	config.seed = 11;
+	config.threads = 1;
+	SimulationReport single = runSimulation(config);
+	config.threads = 4;
+	SimulationReport pooled = runSimulation(config);
+
+	CHECK_EQ(single.perArchetype.size(), config.archetypes.size());
+	CHECK_EQ(pooled.perArchetype.size(), single.perArchetype.size());
+	int campaigns = 0;
+	for (size_t i = 0; i < single.perArchetype.size() && i < pooled.perArchetype.size(); ++i) {
+		CHECK(sameStats(single.perArchetype[i], pooled.perArchetype[i]));
+		campaigns += single.perArchetype[i].campaigns;
+	}
+	CHECK_EQ(campaigns, config.campaigns);
+}
+
+TEST(simulator, campaignIsReproducible) {
+	SimulationConfig config;
+	//Tiered puts alpha-beta enemies in the campaign, which stop on depth alone
+	for (EnemyStrategy enemy : { EnemyStrategy::Perfect, EnemyStrategy::Tiered }) {
+		config.enemy = enemy;
+		for (int i = 0; i < 50; ++i) {
+			CampaignSummary first = simulateCampaign(Archetype::Paladin, config, i);
+			CampaignSummary again = simulateCampaign(Archetype::Paladin, config, i);
+			CHECK(first.result == again.result);
+			CHECK_EQ(first.endStage, again.endStage);
+			CHECK_EQ(first.roundsPlayed, again.roundsPlayed);
+			CHECK(first.hpOnEntry == again.hpOnEntry);
+		}
+	}
+}
+
+TEST(simulator, unknownNamesAreRejected) {
+	for (const char* option : { "--enemy", "--hero", "--archetype", "--path", "--shrine" }) {
+		CHECK_EQ(runCommand(runSimulationCommand, { "1", option, "nonsense" }), 1);
+	}
+	CHECK_EQ(runCommand(runSimulationCommand, { "1", "--hero", "tiered" }), 1);
+}
+
+
+// ------------- Self-Play -------------
+
+TEST(selfplay, digestIgnoresThreadCount) {
+	SelfPlayConfig config;
+	config.games = 2000;
+	config.threads = 1;
+	SelfPlayReport single = runSelfPlay(config);
+	config.threads = 4;
+	SelfPlayReport pooled = runSelfPlay(config);
+	CHECK_EQ(pooled.digest, single.digest);
+	CHECK_EQ(pooled.wins[0], single.wins[0]);
+	CHECK_EQ(pooled.ties, single.ties);
+	CHECK_EQ(single.wins[0] + single.wins[1] + single.ties, config.games);
+}
+
+TEST(selfplay, battleDigestIgnoresThreadCount) {
+	SelfPlayConfig config;
+	config.mode = SelfPlayMode::Battle;
+	config.games = 200;
+	config.bots[0] = BotKind::Search;
+	config.searchDepth = 3;
+	config.threads = 1;
+	uint64_t single = runSelfPlay(config).digest;
+	config.threads = 3;
+	CHECK_EQ(runSelfPlay(config).digest, single);
+}
+
+TEST(selfplay, perfectPlayNeverLoses) {
+	SelfPlayConfig config;
+	config.games = 500;
+	config.bots[0] = BotKind::Perfect;
+	config.bots[1] = BotKind::Perfect;
+	SelfPlayReport both = runSelfPlay(config);
+	CHECK_EQ(both.ties, config.games);
+
+	config.bots[1] = BotKind::Random;
+	CHECK_EQ(runSelfPlay(config).wins[1], 0);
+}
+
+TEST(selfplay, campaignQuitsAreTies) {
+	SelfPlayConfig config;
+	config.mode = SelfPlayMode::Campaign;
+	config.bots[0] = BotKind::Greedy;
+	config.bots[1] = BotKind::Perfect;
+
+	SimulationConfig sim;
+	sim.seed = config.seed;
+	sim.policy.boardPlay = EnemyStrategy::Greedy;
+	sim.enemy = EnemyStrategy::Perfect;
+	int quits = 0;
+	for (int i = 0; i < 200; ++i) {
+		CampaignResult result = simulateCampaign(config.archetypes[0], sim, i).result;
+		int expected = (result == CampaignResult::Victory) ? 0 : (result == CampaignResult::Defeat) ? 1 : -1;
+		CHECK_EQ(playSelfPlayGame(config, i).outcome.winnerSeat, expected);
+		quits += (result == CampaignResult::Quit);
+	}
+	CHECK(quits > 0);
+}
+
+TEST(selfplay, unknownNamesAreRejected) {
+	for (const char* option : { "--p1", "--p2", "--mode", "--arch1", "--arch2" }) {
+		CHECK_EQ(runCommand(runSelfPlayCommand, { "1", option, "nonsense" }), 1);
+	}
+}
+
+
+// ------------- Tournament -------------
+
+TEST(tournament, tablesIgnoreThreadCount) {
+	TournamentConfig config;
+	config.entrants = { BotKind::Random, BotKind::Greedy, BotKind::Search };
+	config.gamesPerPairing = 6;
+	config.searchDepth = 2;
+	config.threads = 1;
+	TournamentReport single = runTournament(config);
+	config.threads = 4;
+	TournamentReport pooled = runTournament(config);
+
+	CHECK_EQ(pooled.digest, single.digest);
+	CHECK_EQ(pooled.games, single.games);
+	for (size_t i = 0; i < single.standings.size() && i < pooled.standings.size(); ++i) {
+		CHECK_EQ(pooled.standings[i].total.points(), single.standings[i].total.points());
+		CHECK_EQ(pooled.standings[i].elo, single.standings[i].elo);
+	}
+}
+
+TEST(tournament, scoresAddUp) {
+	TournamentConfig config;
+	config.entrants = { BotKind::Random, BotKind::Greedy, BotKind::Perfect };
+	config.battle = false;
+	config.gamesPerPairing = 40;
+	TournamentReport report = runTournament(config);
+
+	const int n = static_cast<int>(config.entrants.size());
+	CHECK_EQ(report.games, n * (n - 1) / 2 * config.gamesPerPairing);
+	for (int r = 0; r < n; ++r) {
+		int games = 0;
+		for (int c = 0; c < n; ++c) {
+			const TournamentScore& row = report.headToHead[r][c];
+			const TournamentScore& column = report.headToHead[c][r];
+			CHECK_EQ(row.wins, column.losses);
+			CHECK_EQ(row.ties, column.ties);
+			games += row.games();
+		}
+		CHECK_EQ(report.standings[r].total.games(), games);
+	}
+
+	//Perfect play never loses a regular game, and the ratings say so
+	CHECK_EQ(report.standings[2].total.losses, 0);
+	CHECK(report.standings[2].elo > report.standings[0].elo);
+}
+
+TEST(tournament, oddGameCountsRoundUp) {
+	TournamentConfig config;
+	config.entrants = { BotKind::Random, BotKind::Perfect };
+	config.battle = false;
+	config.gamesPerPairing = 3;
+	TournamentReport report = runTournament(config);
+	CHECK_EQ(report.config.gamesPerPairing, 4);
+	CHECK_EQ(report.games, 4);
+	CHECK_EQ(report.headToHead[0][1].games(), 4);
+
+	CHECK_EQ(runCommand(runTournamentCommand, { "3" }), 1);
+}
+
+// ------------- Match Server -------------
+
+TEST(server, wireActionsRoundTrip) {
+	const Action actions[] = { Action::place(0), Action::place(8), Action::swap(1, 7), Action::shift(4, 5) };
+	for (const Action& a : actions) {
+		Action parsed;
+		CHECK(parseWireAction(formatWireAction(a), parsed));
+		CHECK(parsed == a);
+	}
+
+	Action parsed;
+	CHECK(parseWireAction("PLACE 5", parsed) && parsed == Action::place(4));
+	CHECK(parseWireAction("PLACE 10", parsed));	//Well formed, the rules answer out_of_range
+	for (const char* bad : { "", "PLACE", "PLACE 0", "PLACE 100", "PLACE 5 6", "SWAP 1", "JUMP 1 2", "place 5" }) {
+		CHECK(!parseWireAction(bad, parsed));
+	}
+}
+
+#if defined(__linux__)
+
+TEST(server, loopbackRegular) {
+	LoopbackConfig config;
+	config.bots = 4;
+	config.gamesPerBot = 20;
+	LoopbackReport report = runLoopback(config);
+	CHECK_EQ(report.errors, uint64_t(0));
+	CHECK_EQ(report.firstError, string());
+	CHECK_EQ(report.gamesPlayed, uint64_t(80));
+	CHECK_EQ(report.server.protocolErrors, uint64_t(0));
+}
+
+TEST(server, loopbackBattle) {
+	LoopbackConfig config;
+	config.bots = 4;
+	config.gamesPerBot = 20;
+	config.battle = true;
+	config.seed = 5;
+	LoopbackReport report = runLoopback(config);
+	CHECK_EQ(report.errors, uint64_t(0));
+	CHECK_EQ(report.firstError, string());
+	CHECK_EQ(report.gamesPlayed, uint64_t(80));
+	CHECK(report.server.rejected > 0);	//Bots tried illegal moves and every one was refused
+}
+
+#endif
@@ -0,0 +1,227 @@
+#include "Tests.h"
+
+#include "SaveFile.h"
+#include "SaveStore.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+using namespace std;
+
+
+namespace {
+
+	CampaignSaveData sampleSave(const string& name) {
+		CampaignSaveData data;
+		data.hero.name = name;
+		data.hero.archetype = Archetype::Paladin;
+		data.hero.mark = '#';
+		data.hero.hp = 31;
+		data.hero.maxHP = 45;
+		data.hero.attack = 12;
+		data.hero.defense = 3;
+		data.stage = 6;
+		data.legendWandered = 2;
+		data.legendWilderness = 1;
+		data.hasRng = true;
+		data.rng = Rng(99, 4);
+		data.rng.discard(17);
+		data.lastEnemyType = 3;
+		return data;
+	}
+
+	bool sameSave(const CampaignSaveData& a, const CampaignSaveData& b) {
+		return a.hero.name == b.hero.name && a.hero.archetype == b.hero.archetype && a.hero.mark == b.hero.mark
+			&& a.hero.hp == b.hero.hp && a.hero.maxHP == b.hero.maxHP && a.hero.attack == b.hero.attack
+			&& a.hero.defense == b.hero.defense && a.stage == b.stage && a.legendWandered == b.legendWandered
+			&& a.legendWilderness == b.legendWilderness && a.hasRng == b.hasRng && (!a.hasRng || a.rng == b.rng)
+			&& a.lastEnemyType == b.lastEnemyType;
+	}
+
+	void writeBytes(const string& path, const void* data, size_t size) {
+		ofstream out(path, ios::binary | ios::trunc);
+		out.write(static_cast<const char*>(data), static_cast<streamsize>(size));
+	}
+
+	void removeStore(const string& path) {
+		remove(path.c_str());
+		remove((path + ".tmp").c_str());
+		remove((path + ".lock").c_str());
+	}
+}
+
+
+// ------------- Save File -------------
+
+TEST(save, crcMatchesTheStandardCheck) {
+	CHECK_EQ(crc32("123456789", 9), 0xCBF43926u);
+	CHECK_EQ(crc32("", 0), 0u);
+}
+
+TEST(save, roundTrip) {
+	const string path = "test_save.dat";
+	CampaignSaveData written = sampleSave("Round Trip");
+	CHECK(writeCampaignSave(path, written));
+
+	CampaignSaveData read;
+	CHECK(readCampaignSave(path, read) == SaveStatus::Ok);
+	CHECK(sameSave(read, written));
+	remove(path.c_str());
+
+	CHECK(readCampaignSave(path, read) == SaveStatus::Missing);
+}
+
+TEST(save, corruptFiles) {
+	const string path = "test_corrupt.dat";
+	SaveRecord record = makeSaveRecord(sampleSave("Corrupt"));
+	CampaignSaveData read;
+
+	//One flipped byte fails the CRC
+	SaveRecord flipped = record;
+	flipped.hp ^= 0x40;
+	writeBytes(path, &flipped, sizeof(flipped));
+	CHECK(readCampaignSave(path, read) == SaveStatus::Corrupt);
+
+	//Truncated, and with trailing bytes
+	writeBytes(path, &record, sizeof(record) - 10);
+	CHECK(readCampaignSave(path, read) == SaveStatus::Corrupt);
+	string padded(reinterpret_cast<const char*>(&record), sizeof(record));
+	padded += "extra";
+	writeBytes(path, padded.data(), padded.size());
+	CHECK(readCampaignSave(path, read) == SaveStatus::Corrupt);
+
+	remove(path.c_str());
+}
+
+TEST(save, olderAndNewerVersions) {
+	const string path = "test_versions.dat";
+	CampaignSaveData read;
+
+	//Version 1 ended after the name, with its checksum where rngKey is now
+	SaveRecord v1 = makeSaveRecord(sampleSave("Old Hero"));
+	v1.version = 1;
+	v1.size = SaveRecord::sizeV1;
+	uint32_t crc = crc32(&v1, SaveRecord::sizeV1 - 4);
+	memcpy(reinterpret_cast<char*>(&v1) + SaveRecord::sizeV1 - 4, &crc, sizeof(crc));
+	writeBytes(path, &v1, SaveRecord::sizeV1);
+	CHECK(readCampaignSave(path, read) == SaveStatus::Ok);
+	CHECK_EQ(read.hero.name, string("Old Hero"));
+	CHECK_EQ(read.stage, 6);
+	CHECK(!read.hasRng);
+	CHECK_EQ(read.lastEnemyType, -1);
+
+	SaveRecord future = makeSaveRecord(sampleSave("Future"));
+	future.version = SaveRecord::currentVersion + 1;
+	writeBytes(path, &future, sizeof(future));
+	CHECK(readCampaignSave(path, read) == SaveStatus::NewerVersion);
+
+	remove(path.c_str());
+}
+
+TEST(save, legacyTextMigrates) {
+	const string path = "test_legacy.txt";
+	{
+		ofstream out(path);
+		out << "Legacy Hero\n2 O\n40 45 12 3\n9\n5 2\n";
+	}
+
+	CampaignSaveData read;
+	CHECK(readCampaignSave(path, read) == SaveStatus::Migrated);
+	CHECK_EQ(read.hero.name, string("Legacy Hero"));
+	CHECK(read.hero.archetype == Archetype::Paladin);
+	CHECK_EQ(read.hero.mark, 'O');
+	CHECK_EQ(read.hero.hp, 40);
+	CHECK_EQ(read.hero.maxHP, 45);
+	CHECK_EQ(read.stage, 9);
+	CHECK_EQ(read.legendWilderness, 2);
+
+	{
+		ofstream out(path);
+		out << "Broken\n1 X\n40 forty\n";
+	}
+	CHECK(readCampaignSave(path, read) == SaveStatus::Corrupt);
+	remove(path.c_str());
+}
+
+
+// ------------- Save Store -------------
+
+TEST(store, storeGrowAndRemove) {
+	const string path = "test_store.db";
+	removeStore(path);
+
+	SaveStore store;
+	CHECK(store.open(path, 16));
+	CHECK_EQ(store.capacity(), 16u);
+
+	for (int i = 0; i < 200; ++i) CHECK(store.store(sampleSave("hero" + to_string(i))));
+	CHECK_EQ(store.size(), 200u);
+	CHECK(store.capacity() >= 256u);
+
+	for (int i = 0; i < 200; i += 2) CHECK(store.remove("hero" + to_string(i)));
+	CHECK(!store.remove("hero0"));
+	CHECK_EQ(store.size(), 100u);
+	CHECK_EQ(store.list().size(), size_t(100));
+
+	//Overwrite keeps one slot per hero
+	CampaignSaveData updated = sampleSave("hero1");
+	updated.stage = 9;
+	CHECK(store.store(updated));
+	CHECK_EQ(store.size(), 100u);
+	store.close();
+
+	CHECK(store.open(path));
+	CampaignSaveData read;
+	for (int i = 0; i < 200; ++i) {
+		string name = "hero" + to_string(i);
+		CHECK_EQ(store.contains(name), i % 2 == 1);
+	}
+	CHECK(store.load("hero1", read) == SaveStatus::Ok);
+	CHECK(sameSave(read, updated));
+	CHECK(store.load("hero3", read) == SaveStatus::Ok);
+	CHECK(sameSave(read, sampleSave("hero3")));
+	CHECK(store.load("hero2", read) == SaveStatus::Missing);
+	store.close();
+	removeStore(path);
+}
+
+TEST(store, rejectsForeignFiles) {
+	const string path = "test_foreign.db";
+	removeStore(path);
+	string junk(4096, 'j');
+	writeBytes(path, junk.data(), junk.size());
+
+	SaveStore store;
+	CHECK(!store.open(path));
+	CHECK(!store.isOpen());
+	CHECK(!store.lastError().empty());
+
+	//Still the same bytes, a failed open never rewrites the file
+	ifstream in(path, ios::binary);
+	string back((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+	CHECK(back == junk);
+	in.close();
+	removeStore(path);
+}
+
+TEST(store, oneOwnerAtATime) {
+	const string path = "test_owner.db";
+	removeStore(path);
+
+	SaveStore owner, second;
+	CHECK(owner.open(path, 16));
+	CHECK(!second.open(path));
+	CHECK(!second.lastError().empty());
+
+	//Growing replaces the store file, the lock still holds
+	for (int i = 0; i < 40; ++i) CHECK(owner.store(sampleSave("hero" + to_string(i))));
+	CHECK(!second.open(path));
+
+	owner.close();
+	CHECK(second.open(path));
+	CHECK_EQ(second.size(), 40u);
+	second.close();
+	removeStore(path);
+}
@@ -0,0 +1,324 @@
+#include "Tests.h"
+
+#include "BattleSearch.h"
+#include "EnemyAI.h"
+#include "Mcts.h"
+#include "Rules.h"
+#include "Solver.h"
+#include "Symmetry.h"
+
+#include <algorithm>
+#include <random>
+
+using namespace std;
+
+
+namespace {
+
+	//Plain minimax over placements: +1 mover wins, -1 mover loses, 0 draw
+	int minimax(Mask mover, Mask opponent) {
+		Position p;
+		p.marks[0] = mover;
+		p.marks[1] = opponent;
+		int w = winnerOf(p);
+		if (w != -1) return w == 0 ? 1 : -1;
+		if (p.occupied() == Board::fullMask) return 0;
+
+		int best = -1;
+		for (int i = 0; i < 9; ++i) {
+			if (p.occupied() & cellBit(i)) continue;
+			best = max(best, -minimax(opponent, static_cast<Mask>(mover | cellBit(i))));
+			if (best == 1) break;
+		}
+		return best;
+	}
+
+	bool hasLine(Mask m) {
+		Position p;
+		p.marks[0] = m;
+		return winnerOf(p) == 0;
+	}
+
+	int sign(int v) { return (v > 0) - (v < 0); }
+
+	//Random position reached by plain placements with no line completed yet
+	Position randomOpenPosition(mt19937& rng, int moves) {
+		Position p;
+		uniform_int_distribution<int> cell(0, 8);
+		for (int m = 0; m < moves; ++m) {
+			if (p.occupied() == Board::fullMask) break;
+			int c;
+			do c = cell(rng); while (p.occupied() & cellBit(c));
+			Position next = applyAction(p, Action::place(c));
+			if (winnerOf(next) != -1) break;
+			p = next;
+		}
+		return p;
+	}
+
+	Board boardOf(const Position& p) {
+		Board board;
+		for (int i = 0; i < 9; ++i) {
+			if (p.marks[0] & cellBit(i)) board.set(i, 'X');
+			if (p.marks[1] & cellBit(i)) board.set(i, 'O');
+		}
+		return board;
+	}
+}
+
+
+// ------------- Perfect Play Solver -------------
+
+TEST(solver, matchesMinimax) {
+	const Solver& solver = Solver::instance();
+	int mismatches = 0, checked = 0;
+	for (unsigned mover = 0; mover < 512; ++mover) {
+		for (unsigned opponent = 0; opponent < 512; ++opponent) {
+			if (mover & opponent) continue;
+			//Only positions a plain game reaches: the mover never has more marks, one line at most
+			int lead = popCount(opponent) - popCount(mover);
+			if (lead != 0 && lead != 1) continue;
+
+			Mask m = static_cast<Mask>(mover), o = static_cast<Mask>(opponent);
+			if (hasLine(m) && hasLine(o)) continue;
+
+			const SolverEntry& e = solver.lookup(Solver::encode(m, o));
+			if (sign(e.score) != minimax(m, o)) ++mismatches;
+			++checked;
+		}
+	}
+	CHECK_EQ(mismatches, 0);
+	CHECK(checked > 5000);
+}
+
+TEST(solver, bestMoveKeepsTheResult) {
+	const Solver& solver = Solver::instance();
+	mt19937 rng(2);
+	for (int i = 0; i < 2000; ++i) {
+		Position p = randomOpenPosition(rng, static_cast<int>(rng() % 8));
+		Mask mover = p.marks[p.side], opponent = p.marks[p.side ^ 1];
+		const SolverEntry& e = solver.lookup(Solver::encode(mover, opponent));
+		CHECK(e.bestMove >= 0);
+		CHECK(!(p.occupied() & cellBit(e.bestMove)));
+
+		//The reply's value from the opponent's side is the negation of ours
+		int after = minimax(opponent, static_cast<Mask>(mover | cellBit(e.bestMove)));
+		CHECK_EQ(-after, sign(e.score));
+	}
+}
+
+
+// ------------- Battle Moves -------------
+
+TEST(battle, generatedActionsAreExactlyTheValidOnes) {
+	mt19937 rng(3);
+	const Archetype archetypes[] = { Archetype::None, Archetype::Alchemist, Archetype::Paladin };
+	for (int i = 0; i < 3000; ++i) {
+		Position p = randomOpenPosition(rng, static_cast<int>(rng() % 9));
+		p.side = 0;
+		Board board = boardOf(p);
+
+		for (Archetype arch : archetypes) {
+			ActionList generated;
+			generateActions(p, arch, generated);
+			for (const Action& m : generated) CHECK(validateAction(board, m, arch) == ActionError::None);
+
+			//Everything valid shows up, swaps once with a < b
+			int valid = 0;
+			for (int type = 0; type < 3; ++type) {
+				for (int a = 0; a < 9; ++a) {
+					for (int b = (type == 0 ? -1 : 0); b < (type == 0 ? 0 : 9); ++b) {
+						Action m{ static_cast<ActionType>(type), static_cast<int8_t>(a), static_cast<int8_t>(b) };
+						if (validateAction(board, m, arch) != ActionError::None) continue;
+						if (m.type == ActionType::Swap && m.a > m.b) continue;
+						++valid;
+						CHECK(find(generated.begin(), generated.end(), m) != generated.end());
+					}
+				}
+			}
+			CHECK_EQ(generated.count, valid);
+		}
+	}
+}
+
+TEST(battle, applyMatchesTheBoard) {
+	mt19937 rng(4);
+	for (int i = 0; i < 3000; ++i) {
+		Position p = randomOpenPosition(rng, static_cast<int>(rng() % 9));
+		p.side = static_cast<int>(rng() % 2);
+		ActionList moves;
+		generateActions(p, (i % 2) ? Archetype::Alchemist : Archetype::Paladin, moves);
+		if (moves.count == 0) continue;
+		const Action& m = moves.moves[rng() % moves.count];
+
+		Board board = boardOf(p);
+		applyAction(board, m, p.side ? 'O' : 'X');
+		Position next = applyAction(p, m);
+		CHECK_EQ(next.marks[0], board.maskFor('X'));
+		CHECK_EQ(next.marks[1], board.maskFor('O'));
+		CHECK_EQ(next.side, p.side ^ 1);
+	}
+}
+
+TEST(battle, winnerAfterMatchesWinner) {
+	mt19937 rng(10);
+	for (int i = 0; i < 3000; ++i) {
+		Position p = randomOpenPosition(rng, static_cast<int>(rng() % 9));
+		ActionList moves;
+		generateActions(p, (i % 2) ? Archetype::Alchemist : Archetype::Paladin, moves);
+		for (const Action& m : moves) {
+			Board board = boardOf(p);
+			applyAction(board, m, p.side ? 'O' : 'X');
+			CHECK_EQ(winnerAfter(board, m), board.winner());
+		}
+	}
+
+	//X X O / . O . / X . . : swapping 2 and 6 completes the top row for X
+	Board board;
+	for (int c : { 0, 1, 6 }) board.set(c, 'X');
+	for (int c : { 2, 4 }) board.set(c, 'O');
+	Action swap = Action::swap(2, 6);
+	applyAction(board, swap, 'X');
+	CHECK_EQ(winnerAfter(board, swap), 'X');
+}
+
+TEST(battle, searchTakesTheWin) {
+	//X X . / O O . / . . . with X to move: only cell 2 wins now
+	Position p;
+	p.marks[0] = static_cast<Mask>(cellBit(0) | cellBit(1));
+	p.marks[1] = static_cast<Mask>(cellBit(3) | cellBit(4));
+
+	BattleSearch search;
+	search.reset(Archetype::Alchemist, Archetype::Paladin, 4);
+	Action best = search.bestMove(p);
+	CHECK(best == Action::place(2));
+	CHECK(search.lastScore > BattleSearch::winScore / 2);
+}
+
+
+// ------------- Symmetries -------------
+
+TEST(symmetry, canonicalCodeIsSharedByTheClass) {
+	mt19937 rng(5);
+	for (int i = 0; i < 5000; ++i) {
+		Position p = randomOpenPosition(rng, static_cast<int>(rng() % 9));
+		p.side = i % 2;
+		Canonical c = canonicalize(p);
+				CHECK_EQ(Solver::encode(transformMask(p.marks[0], c.symmetry), transformMask(p.marks[1], c.symmetry)) * 2 + p.side, c.code);
+
+		for (int s = 0; s < symmetryCount; ++s) {
+			CHECK_EQ(canonicalize(transformPosition(p, s)).code, c.code);
+			CHECK_EQ(transformCell(transformCell(4, s), inverse_symmetry[s]), 4);
+		}
+
+		ActionList moves;
+		generateActions(p, Archetype::Paladin, moves);
+		for (const Action& m : moves) CHECK(c.fromCanonical(c.toCanonical(m)) == m);
+	}
+}
+
+TEST(symmetry, searchScoreIsTheSameInEveryOrientation) {
+	mt19937 rng(6);
+	for (int i = 0; i < 60; ++i) {
+		Position p = randomOpenPosition(rng, 2 + static_cast<int>(rng() % 5));
+		int s = 1 + static_cast<int>(rng() % (symmetryCount - 1));
+
+		BattleSearch original, turned;
+		original.reset(Archetype::Alchemist, Archetype::Paladin, 4);
+		turned.reset(Archetype::Alchemist, Archetype::Paladin, 4);
+		Action best = original.bestMove(p);
+		turned.bestMove(transformPosition(p, s));
+		CHECK_EQ(turned.lastScore, original.lastScore);
+
+		//The move maps onto a legal move of the turned board
+		Board board = boardOf(transformPosition(p, s));
+		CHECK(validateAction(board, transformAction(best, s), p.side ? Archetype::Paladin : Archetype::Alchemist) == ActionError::None);
+	}
+}
+
+
+// ------------- Campaign Enemies -------------
+
+TEST(enemy, fullDepthSearchMatchesTheSolver) {
+	const Solver& solver = Solver::instance();
+	mt19937 rng(7);
+	EnemySearch search;
+	for (int i = 0; i < 400; ++i) {
+		Position p = randomOpenPosition(rng, static_cast<int>(rng() % 8));
+		Board board = boardOf(p);
+		char mover = p.side ? 'O' : 'X', opponent = p.side ? 'X' : 'O';
+
+		int cell = search.bestMove(board, mover, opponent, 9, 0);
+		CHECK(cell >= 0 && board.get(cell) == ' ');
+		CHECK(!search.lastTimedOut);
+		int expected = sign(solver.lookup(Solver::encode(board, mover, opponent)).score);
+		CHECK_EQ(sign(search.lastScore), expected);
+
+		//The chosen cell keeps the solved result
+		board.set(cell, mover);
+		CHECK_EQ(-sign(solver.lookup(Solver::encode(board, opponent, mover)).score), expected);
+	}
+}
+
+TEST(enemy, answerDependsOnlyOnThePosition) {
+	mt19937 rng(8);
+	EnemySearch shared;
+	for (int i = 0; i < 300; ++i) {
+		Board board = boardOf(randomOpenPosition(rng, 2 * static_cast<int>(rng() % 4)));
+		int depth = 1 + static_cast<int>(rng() % 4);
+		EnemySearch fresh;
+		CHECK_EQ(shared.bestMove(board, 'X', 'O', depth, 0), fresh.bestMove(board, 'X', 'O', depth, 0));
+		CHECK_EQ(shared.lastScore, fresh.lastScore);
+	}
+}
+
+TEST(enemy, greedyWinsThenBlocks) {
+	//X X . / O O . / . . . : X takes the win at 2, O would block there and win at 5
+	Board board;
+	board.set(0, 'X');
+	board.set(1, 'X');
+	board.set(3, 'O');
+	board.set(4, 'O');
+	CHECK_EQ(greedyCell(board, 'X', 'O'), 2);
+	CHECK_EQ(greedyCell(board, 'O', 'X'), 5);
+
+	board.set(5, 'X');
+	CHECK_EQ(greedyCell(board, 'O', 'X'), 2);
+	CHECK_EQ(greedyCell(Board(), 'X', 'O'), -1);
+}
+
+
+// ------------- Monte Carlo Tree Search -------------
+
+TEST(mcts, takesAndBlocksTheWin) {
+	const Archetype none[2] = { Archetype::None, Archetype::None };
+	MctsConfig config;
+	config.iterations = 4000;
+	MctsSearch search(config);
+
+	//X X . / O O . / . . . with X to move: cell 2 wins now
+	Position p;
+	p.marks[0] = static_cast<Mask>(cellBit(0) | cellBit(1));
+	p.marks[1] = static_cast<Mask>(cellBit(3) | cellBit(4));
+	CHECK(search.bestAction(p, none, 1) == Action::place(2));
+	CHECK(search.lastScore > 0.9);
+
+	//X . . / O O . / X . . with X to move: only cell 5 stops O
+	p.marks[0] = static_cast<Mask>(cellBit(0) | cellBit(6));
+	CHECK(search.bestAction(p, none, 2) == Action::place(5));
+}
+
+TEST(mcts, sameSeedSameMove) {
+	const Archetype archetypes[2] = { Archetype::Alchemist, Archetype::Paladin };
+	mt19937 rng(9);
+	MctsConfig config;
+	config.iterations = 3000;
+	config.threads = 3;
+	MctsSearch first(config), second(config);
+	for (int i = 0; i < 20; ++i) {
+		Position p = randomOpenPosition(rng, static_cast<int>(rng() % 7));
+		uint64_t seed = rng();
+		CHECK(first.bestAction(p, archetypes, seed) == second.bestAction(p, archetypes, seed));
+		CHECK_EQ(first.lastIterations, uint64_t(config.iterations));
+	}
+}
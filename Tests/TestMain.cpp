@@ -0,0 +1,48 @@
+#include "Tests.h"
+
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+
+
+namespace {
+	int failures = 0;
+}
+
+vector<TestCase>& testRegistry() {
+	static vector<TestCase> registry;
+	return registry;
+}
+
+void reportFailure(const char* file, int line, const string& what) {
+	++failures;
+	cerr << "  " << file << ":" << line << ": CHECK failed: " << what << "\n";
+}
+
+
+// ------------- Runner -------------
+
+//tests [suite]: every case, or only the named suite's
+int main(int argc, char* argv[]) {
+	const char* only = (argc > 1) ? argv[1] : nullptr;
+
+	int ran = 0, failedCases = 0;
+	for (const TestCase& t : testRegistry()) {
+		if (only && strcmp(only, t.suite) != 0) continue;
+
+		int before = failures;
+		t.body();
+		++ran;
+		bool ok = (failures == before);
+		if (!ok) ++failedCases;
+		cout << (ok ? "[ ok ] " : "[FAIL] ") << t.suite << "." << t.name << "\n";
+	}
+
+	if (ran == 0) {
+		cerr << "No tests match " << (only ? only : "") << "\n";
+		return 1;
+	}
+	cout << ran - failedCases << " of " << ran << " passed\n";
+	return failedCases ? 1 : 0;
+}
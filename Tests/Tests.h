@@ -0,0 +1,46 @@
+#pragma once
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+// ------------- Test Harness -------------
+
+// TEST(suite, name) registers a case at startup; CHECK and CHECK_EQ record a
+// failure and keep going, so one run lists every broken assertion. The runner
+// takes an optional suite name, so each suite can run on its own.
+
+struct TestCase {
+	const char* suite;
+	const char* name;
+	void (*body)();
+};
+
+std::vector<TestCase>& testRegistry();
+void reportFailure(const char* file, int line, const std::string& what);
+
+struct TestRegistrar {
+	TestRegistrar(const char* suite, const char* name, void (*body)()) { testRegistry().push_back({ suite, name, body }); }
+};
+
+#define TEST(suite, name) \
+	static void suite##_##name(); \
+	static TestRegistrar suite##_##name##_registrar(#suite, #name, suite##_##name); \
+	static void suite##_##name()
+
+#define CHECK(cond) \
+	do { \
+		if (!(cond)) reportFailure(__FILE__, __LINE__, #cond); \
+	} while (0)
+
+#define CHECK_EQ(actual, expected) \
+	do { \
+		const auto& actualValue = (actual); \
+		const auto& expectedValue = (expected); \
+		if (!(actualValue == expectedValue)) { \
+			std::ostringstream message; \
+			message << #actual << " == " << #expected << " (got " << actualValue << ", expected " << expectedValue << ")"; \
+			reportFailure(__FILE__, __LINE__, message.str()); \
+		} \
+	} while (0)
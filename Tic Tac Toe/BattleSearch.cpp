@@ -0,0 +1,115 @@
+#include "BattleSearch.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+
+using namespace std;
+
+
+void BattleSearch::reset(Archetype p1, Archetype p2, int depth) {
+	archetypes[0] = p1;
+	archetypes[1] = p2;
+	maxDepth = depth;
+	table = TranspositionCache<TTEntry>();
+}
+
+Action BattleSearch::bestMove(const Position& p) {
+	if (table.empty()) reset(archetypes[0], archetypes[1], maxDepth);
+	nodes = 0;
+	Action best;
+	for (int depth = 1; depth <= maxDepth; ++depth) {
+		path.clear();
+		repetitionFloor = INT_MAX;
+		lastScore = negamax(p, depth, -winScore - 1, winScore + 1);
+		Canonical c = canonicalize(p);
+		best = c.fromCanonical(table.at(c.code).move);
+		if (abs(lastScore) > winScore / 2) break; //Forced result found
+	}
+	return best;
+}
+
+//Open lines weighted by how many marks they already hold
+int BattleSearch::evaluate(const Position& p) {
+	Mask me = p.marks[p.side], them = p.marks[p.side ^ 1];
+	int score = 0;
+	for (Mask line : win_masks) {
+		int mine = popCount(me & line), theirs = popCount(them & line);
+		if (theirs == 0) score += mine * mine;
+		if (mine == 0) score -= theirs * theirs;
+	}
+	return score;
+}
+
+//Scores are relative to the node, wins decay by one per ply so faster wins rank higher
+int BattleSearch::negamax(const Position& p, int depth, int alpha, int beta) {
+	++nodes;
+	int w = winnerOf(p);
+	if (w != -1) return (w == p.side) ? winScore : -winScore;
+	if (p.occupied() == Board::fullMask) return 0;
+
+	int k = key(p);
+	auto repeated = find(path.begin(), path.end(), k);
+	if (repeated != path.end()) { //Repetition
+		repetitionFloor = min(repetitionFloor, static_cast<int>(repeated - path.begin()));
+		return 0;
+	}
+	if (depth == 0) return evaluate(p);
+
+	Canonical c = canonicalize(p);
+	TTEntry& tt = table.at(c.code);
+	if (tt.depth >= depth) {
+		if (tt.flag == Exact) return tt.score;
+		if (tt.flag == Lower && tt.score >= beta) return tt.score;
+		if (tt.flag == Upper && tt.score <= alpha) return tt.score;
+	}
+
+	ActionList moves;
+	generateActions(p, archetypes[p.side], moves);
+
+	//Try the stored best move first
+	if (tt.depth >= 0) {
+		Action stored = c.fromCanonical(tt.move);
+		for (int i = 1; i < moves.count; ++i) {
+			if (moves.moves[i] == stored) {
+				swap(moves.moves[0], moves.moves[i]);
+				break;
+			}
+		}
+	}
+
+	int alphaStart = alpha;
+	int best = -winScore - 1;
+	Action bestMove = moves.moves[0];
+
+	int ply = static_cast<int>(path.size());
+	int outerFloor = repetitionFloor;
+	repetitionFloor = INT_MAX;
+
+	path.push_back(k);
+	for (const Action& m : moves) {
+		int score = -negamax(applyAction(p, m), depth - 1, -beta, -alpha);
+		if (score > winScore / 2) --score;
+		else if (score < -winScore / 2) ++score;
+
+		if (score > best) {
+			best = score;
+			bestMove = m;
+		}
+		if (best > alpha) alpha = best;
+		if (alpha >= beta) break;
+	}
+	path.pop_back();
+
+	//A draw by repeating a position above this node only holds for this line, so the score can't be shared
+	bool historyFree = repetitionFloor >= ply;
+	repetitionFloor = min(outerFloor, repetitionFloor);
+
+	tt.move = c.toCanonical(bestMove);	//Still a good first move to try
+	if (historyFree) {
+		tt.score = static_cast<int16_t>(best);
+		tt.depth = static_cast<int8_t>(depth);
+		tt.flag = (best <= alphaStart) ? Upper : (best >= beta) ? Lower : Exact;
+	}
+	return best;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Rules.h"
+#include "Symmetry.h"
+
+#include <vector>
+
+
+// ------------- Battle Search -------------
+
+// Battle positions are tiny (two 9-bit masks and the side to move), so the
+// whole state space fits in a flat 2 * 3^9 transposition table, keyed by
+// canonical code so all 8 symmetric copies of a position share one entry.
+// Swaps and shifts make the game cyclic; a position repeated on the current
+// search line is scored as a draw, and a node whose score leaned on such a
+// draw from above it is not stored, since another line may not repeat.
+class BattleSearch {
+public:
+	static constexpr int winScore = 1000;
+
+	//Exact position, for repetition checks
+	static int key(const Position& p) { return Solver::encode(p.marks[0], p.marks[1]) * 2 + p.side; }
+
+	void reset(Archetype p1, Archetype p2, int depth = 9);
+
+	//Iterative deepening up to maxDepth, returns the best action for p.side
+	Action bestMove(const Position& p);
+
+	int lastScore = 0;		//From the mover's point of view
+	uint64_t nodes = 0;
+
+private:
+	enum : uint8_t { Exact, Lower, Upper };
+
+	struct TTEntry {
+		int16_t score = 0;
+		int8_t depth = -1;
+		uint8_t flag = Exact;
+		Action move;	//Canonical orientation
+	};
+
+	Archetype archetypes[2] = { Archetype::None, Archetype::None };
+	int maxDepth = 9;
+	TranspositionCache<TTEntry> table{ 0 };
+	std::vector<int> path;	//Keys on the current search line
+	int repetitionFloor = 0;	//Shallowest path index a repetition below the current node went back to
+
+	static int evaluate(const Position& p);
+	int negamax(const Position& p, int depth, int alpha, int beta);
+};
@@ -0,0 +1,532 @@
+#pragma once
+
+#include <iostream>
+#include <array>
+#include <bitset>
+#include <string>
+#include <type_traits>
+#include <cstdint>
+#include <cstddef>
+#include <cassert>
+
+#include "Profile.h"
+#include "Rng.h"
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+
+// ------------- Bitboard Helpers -------------
+
+using Mask = uint16_t;	//One bit per cell, bit i = cell i
+
+inline int popCount(unsigned m) {
+#if defined(_MSC_VER)
+	return static_cast<int>(__popcnt(m));
+#elif defined(__GNUC__) || defined(__clang__)
+	return __builtin_popcount(m);
+#else
+	int n = 0;
+	for (; m; m &= m - 1) ++n;
+	return n;
+#endif
+}
+
+inline int popCount64(uint64_t m) {
+#if defined(_MSC_VER) && defined(_M_X64)
+	return static_cast<int>(__popcnt64(m));
+#elif defined(__GNUC__) || defined(__clang__)
+	return __builtin_popcountll(m);
+#else
+	return popCount(static_cast<unsigned>(m)) + popCount(static_cast<unsigned>(m >> 32));
+#endif
+}
+
+inline constexpr Mask cellBit(int idx) { return static_cast<Mask>(1u << idx); }
+
+//Smallest integer bitboard that fits the cells, std::bitset past 64
+template<int Cells>
+using CellMask = std::conditional_t<(Cells <= 16), uint16_t,
+	std::conditional_t<(Cells <= 32), uint32_t,
+	std::conditional_t<(Cells <= 64), uint64_t, std::bitset<Cells>>>>;
+
+template<int Cells>
+constexpr CellMask<Cells> makeFullMask() {
+	using M = CellMask<Cells>;
+	if constexpr (std::is_integral_v<M>) {
+		return static_cast<M>((Cells == 64) ? ~M{} : ((M{ 1 } << (Cells % 64)) - 1));
+	}
+	else {
+		return ~M{};
+	}
+}
+
+
+// -- Zobrist Keys --
+
+// One random key per (seat, cell) plus one for the side to move, from a fixed
+// splitmix64 stream so hashes match across builds and runs. Keys belong to the
+// first and second player rather than to a mark char, so an X/O position and
+// the same position in custom marks hash alike.
+template<int Cells>
+struct ZobristKeys {
+	std::array<std::array<uint64_t, Cells>, 2> cell{};
+	uint64_t side = 0;
+};
+
+template<int Cells>
+constexpr ZobristKeys<Cells> makeZobristKeys() {
+	ZobristKeys<Cells> out{};
+	uint64_t state = 0x5A0B1257ull;
+	for (auto& keys : out.cell) {
+		for (int idx = 0; idx < Cells; ++idx) keys[idx] = Rng::mix(state += 0x9E3779B97F4A7C15ull);
+	}
+	out.side = Rng::mix(state += 0x9E3779B97F4A7C15ull);
+	return out;
+}
+
+
+// ------------- Board Geometry -------------
+
+// Every K-in-a-row line of an N x N board, generated at compile time. Lines
+// are ordered rows, columns, diagonals, anti-diagonals, so the 3x3 board keeps
+// the original win_lines order.
+
+inline constexpr int lineCountFor(int n, int k) { return 2 * n * (n - k + 1) + 2 * (n - k + 1) * (n - k + 1); }
+
+template<int N, int K>
+constexpr auto makeLines() {
+	std::array<std::array<int, K>, lineCountFor(N, K)> out{};
+	constexpr int dirs[4][2] = { {0, 1}, {1, 0}, {1, 1}, {1, -1} };
+	size_t l = 0;
+	for (const auto& d : dirs) {
+		for (int r = 0; r < N; ++r) {
+			for (int c = 0; c < N; ++c) {
+				int endR = r + d[0] * (K - 1), endC = c + d[1] * (K - 1);
+				if (endR < 0 || endR >= N || endC < 0 || endC >= N) continue;
+				for (int i = 0; i < K; ++i) out[l][i] = (r + d[0] * i) * N + (c + d[1] * i);
+				++l;
+			}
+		}
+	}
+	return out;
+}
+
+//Lines through each cell, by index into the line table
+template<int K>
+struct CellLineList {
+	uint8_t count = 0;
+	std::array<uint16_t, 4 * K> ids{};
+};
+
+template<int N, int K>
+struct BoardGeometry {
+	static_assert(1 <= K && K <= N, "Need 1 <= K <= N");
+
+	static constexpr int cells = N * N;
+	static constexpr int lineCount = lineCountFor(N, K);
+
+	using MaskType = CellMask<cells>;
+	static constexpr bool bitboard = std::is_integral_v<MaskType>;	//Otherwise walk directions instead of masks
+
+	static constexpr std::array<std::array<int, K>, lineCount> lines = makeLines<N, K>();
+
+	static constexpr std::array<CellLineList<K>, cells> makeCellLineLists() {
+		std::array<CellLineList<K>, cells> out{};
+		for (int l = 0; l < lineCount; ++l) {
+			for (int cell : lines[l]) {
+				auto& list = out[cell];
+				list.ids[list.count++] = static_cast<uint16_t>(l);
+			}
+		}
+		return out;
+	}
+
+	static constexpr std::array<MaskType, bitboard ? lineCount : 0> makeLineMasks() {
+		std::array<MaskType, bitboard ? lineCount : 0> out{};
+		if constexpr (bitboard) {
+			for (int l = 0; l < lineCount; ++l) {
+				for (int cell : lines[l]) out[l] |= static_cast<MaskType>(MaskType{ 1 } << cell);
+			}
+		}
+		return out;
+	}
+};
+
+//Filled outside the class so the generators see a complete type
+template<int N, int K>
+struct BoardTables {
+	using G = BoardGeometry<N, K>;
+	static constexpr auto cellLines = G::makeCellLineLists();
+	static constexpr auto lineMasks = G::makeLineMasks();
+	static constexpr auto zobrist = makeZobristKeys<G::cells>();
+};
+
+
+// ------------- Board Lookup Tables -------------
+
+// Everything below is generated at compile time from win_lines, so the hot
+// path (winner, isAdjacent, Paladin checks) never allocates or searches.
+
+inline constexpr const std::array<std::array<int, 3>, 8>& win_lines = BoardGeometry<3, 3>::lines;	//rows, colums, diagonals
+
+//Bit l set when the cell lies on win line l
+constexpr std::array<uint8_t, 9> makeCellLines() {
+	std::array<uint8_t, 9> out{};
+	for (size_t l = 0; l < win_lines.size(); ++l) {
+		for (int cell : win_lines[l]) out[cell] |= static_cast<uint8_t>(1u << l);
+	}
+	return out;
+}
+
+//The up to eight neighbours of each cell, diagonals included
+constexpr std::array<Mask, 9> makeAdjacencyMasks() {
+	std::array<Mask, 9> out{};
+	for (int idx = 0; idx < 9; ++idx) {
+		int r = idx / 3, c = idx % 3;
+		for (int dr = -1; dr <= 1; ++dr) {
+			for (int dc = -1; dc <= 1; ++dc) {
+				if (dr == 0 && dc == 0) continue;
+				int rr = r + dr, cc = c + dc;
+				if (0 <= rr && rr < 3 && 0 <= cc && cc < 3) out[idx] |= cellBit(rr * 3 + cc);
+			}
+		}
+	}
+	return out;
+}
+
+inline constexpr const std::array<Mask, 8>& win_masks = BoardTables<3, 3>::lineMasks;
+inline constexpr std::array<uint8_t, 9> cell_lines = makeCellLines();
+inline constexpr std::array<Mask, 9> adjacency_masks = makeAdjacencyMasks();
+
+static_assert(win_masks[0] == 0x007 && win_masks[7] == 0x054, "win_masks out of sync with win_lines");
+static_assert(cell_lines[4] == 0xD2, "centre lies on the middle row, middle column and both diagonals");
+static_assert(adjacency_masks[4] == (0x1FF & ~cellBit(4)), "centre touches every other cell");
+static_assert(BoardGeometry<15, 5>::lineCount == 572, "15x15 five-in-a-row has 572 lines");
+
+//True when the mark's cells complete a line running through idx
+inline bool completesLineThrough(Mask marks, int idx) {
+	for (uint8_t lines = cell_lines[idx]; lines; lines &= lines - 1) {
+		Mask line = win_masks[popCount(static_cast<unsigned>((lines & -lines) - 1))];
+		if ((marks & line) == line) return true;
+	}
+	return false;
+}
+
+//Neighbouring cells as a mask (bit i = cell i)
+inline Mask adjacentCells(int idx) { return adjacency_masks[idx]; }
+
+inline bool isAdjacent(int from, int to) {
+	return (adjacency_masks[from] & cellBit(to)) != 0;
+}
+
+
+// ------------- Board -------------
+
+// The board is stored as one mask per mark plus an occupancy mask.
+// get()/set() still speak in chars, so any custom Battle mark works; a board
+// holds at most two distinct marks at a time (one slot per player).
+// Each slot also keeps how many cells it holds on every line, updated by
+// set()/swapCells()/moveCell() through the touched cells only, so winner and
+// draw status are O(1) queries. A Zobrist hash is kept the same way, keyed by
+// seat: X and O by default, or the pair given to setSeatMarks(), so equal
+// boards hash equally whichever mark moved first.
+// Board is the classic 3x3 instantiation.
+template<int N, int K>
+class BasicBoard {
+public:
+	using Geometry = BoardGeometry<N, K>;
+	using MaskType = typename Geometry::MaskType;
+
+	static constexpr int size = N;			//Cells per row
+	static constexpr int winLength = K;		//Marks in a row to win
+	static constexpr int cells = N * N;
+	static inline const MaskType fullMask = makeFullMask<cells>();
+
+	BasicBoard() { clearBoard(); }
+
+	//Marks of the first and second player, for the hash; kept across clearBoard().
+	//A mark outside the pair takes the seat the other mark on the board leaves free.
+	void setSeatMarks(char first, char second) {
+		seatMarks[0] = first;
+		seatMarks[1] = second;
+	}
+
+	void clearBoard() {
+		marks[0] = marks[1] = ' ';
+		seats[0] = 0;
+		seats[1] = 1;
+		masks[0] = masks[1] = MaskType{};
+		occupied = MaskType{};
+		lineFill[0].fill(0);
+		lineFill[1].fill(0);
+		completeLines[0] = completeLines[1] = 0;
+		zobrist = 0;
+	}
+
+	//Reads a Cell
+	char get(int idx) const {
+		if (!test(occupied, idx)) return ' ';
+		return test(masks[0], idx) ? marks[0] : marks[1];
+	}
+
+	//Writes into a Cell with a Mark (' ' clears it).
+	//False, and the board untouched, for a third distinct mark: a board holds two at most.
+	bool set(int idx, char value) {
+		if (value != ' ' && !canHold(value, idx)) return false;
+		if (test(occupied, idx)) removeCell(slotAt(idx), idx);
+		if (value == ' ') return true;
+
+		addCell(slotFor(value), idx);
+		return true;
+	}
+
+	//Alchemist Swap, exchanges the owners of two cells
+	void swapCells(int a, int b) {
+		bool heldA = test(occupied, a), heldB = test(occupied, b);
+		int slotA = heldA ? slotAt(a) : -1;
+		int slotB = heldB ? slotAt(b) : -1;
+		if (slotA == slotB) return;
+
+		if (heldA) removeCell(slotA, a);
+		if (heldB) removeCell(slotB, b);
+		if (heldA) addCell(slotA, b);
+		if (heldB) addCell(slotB, a);
+	}
+
+	//Paladin Shift, moves a mark onto an empty cell
+	void moveCell(int from, int to) {
+		if (!test(occupied, from) || test(occupied, to)) return;
+
+		int slot = slotAt(from);
+		removeCell(slot, from);
+		addCell(slot, to);
+	}
+
+	bool isFull() const { return occupied == fullMask; }
+
+	//Battle Mode Only
+	int countPlaced() const { return count(occupied); }
+
+	bool hasWinner() const { return (completeLines[0] | completeLines[1]) != 0; }
+	bool isDraw() const { return isFull() && !hasWinner(); }
+
+	//Owner of the first completed line (a swap can complete lines for both marks)
+	char winner() const {
+		TTT_PROFILE_COUNT(WinCheck);
+		if (!hasWinner()) return ' '; //No Winner
+		if (!completeLines[1]) return marks[0]; // X/O or Custom Mark
+		if (!completeLines[0]) return marks[1];
+
+		for (int l = 0; l < Geometry::lineCount; ++l) {
+			if (lineFill[0][l] == K) return marks[0];
+			if (lineFill[1][l] == K) return marks[1];
+		}
+		return ' ';
+	}
+
+	//Mark completing a line through idx, only the lines that cell can change
+	char winnerThrough(int idx) const {
+		if (!test(occupied, idx)) return ' ';
+		int slot = slotAt(idx);
+		if (!completeLines[slot]) return ' ';
+
+		const auto& list = BoardTables<N, K>::cellLines[idx];
+		for (int i = 0; i < list.count; ++i) {
+			if (lineFill[slot][list.ids[i]] == K) return marks[slot];
+		}
+		return ' ';
+	}
+
+	MaskType occupiedMask() const { return occupied; }
+
+	//64-bit position hash in O(1), the XOR of zobristKey() over every held cell; sideToMove 1 folds in the side key
+	uint64_t hash(int sideToMove = 0) const {
+		return sideToMove ? zobrist ^ BoardTables<N, K>::zobrist.side : zobrist;
+	}
+
+	static uint64_t zobristKey(int seat, int idx) {
+		return BoardTables<N, K>::zobrist.cell[seat][idx];
+	}
+
+	//Seat a mark on the board hashes as, -1 when it holds no cell
+	int seatOf(char mark) const {
+		for (int s = 0; s < 2; ++s) {
+			if (marks[s] == mark && any(masks[s])) return seats[s];
+		}
+		return -1;
+	}
+
+	MaskType maskFor(char mark) const {
+		if (mark == ' ') return static_cast<MaskType>(~occupied & fullMask);
+		if (any(masks[0]) && marks[0] == mark) return masks[0];
+		if (any(masks[1]) && marks[1] == mark) return masks[1];
+		return MaskType{};
+	}
+
+	//Appends the printBoard() frame, so a renderer can reuse one buffer
+	void formatBoard(std::string& out) const {
+		out += '\n';
+		for (int r = 0; r < N; ++r) {
+			for (int c = 0; c < N; ++c) {
+				out += (c == 0) ? " " : " | ";
+				appendCell(out, N * r + c);
+			}
+			out += '\n';
+			if (r + 1 < N) out.append(N * (cellWidth + 2) + N - 1, '-');
+			out += '\n';
+		}
+		out += "Enter: ";
+		appendCellRange(out);
+		out += "\n\n";
+	}
+
+	//What parseMove accepts for this board: "1-9 or a-i", or just "1-225" past 26 cells
+	static void appendCellRange(std::string& out) {
+		out += "1-";
+		appendNumber(out, cells, 0);
+		if (cells <= 26) {
+			out += " or a-";
+			out += static_cast<char>('a' + cells - 1);
+		}
+	}
+
+	//Empty cells show their index, Occupied their Symbol, right aligned to cellWidth
+	void appendCell(std::string& out, int idx) const {
+		char c = get(idx);
+		if (c == ' ') {
+			appendNumber(out, idx + 1, cellWidth);
+		}
+		else {
+			out.append(cellWidth - 1, ' ');
+			out += c;
+		}
+	}
+
+	void printBoard() const {
+		TTT_PROFILE_SCOPE(Render);
+		thread_local std::string frame;
+		frame.clear();
+		formatBoard(frame);
+		std::cout.write(frame.data(), static_cast<std::streamsize>(frame.size()));
+	}
+
+	static constexpr int cellWidth = (cells >= 100) ? 3 : (cells >= 10) ? 2 : 1;	//Widest cell number
+
+
+private:
+	char marks[2];			//Mark owning each slot
+	int seats[2];			//Seat each slot's mark hashes as
+	char seatMarks[2] = { 'X', 'O' };
+	MaskType masks[2];		//Cells held by each slot
+	MaskType occupied;		//masks[0] | masks[1]
+
+	// -- Line Counters --
+	std::array<uint8_t, Geometry::lineCount> lineFill[2];	//Cells each slot holds on every line
+	int completeLines[2];									//Lines a slot fills entirely
+	uint64_t zobrist;										//XOR of the keys of every held (seat, cell)
+
+	int slotAt(int idx) const { return test(masks[0], idx) ? 0 : 1; }
+
+	static void appendNumber(std::string& out, int n, int width) {
+		char digits[8];
+		int len = 0;
+		do {
+			digits[len++] = static_cast<char>('0' + n % 10);
+			n /= 10;
+		} while (n);
+		if (width > len) out.append(width - len, ' ');
+		while (len) out += digits[--len];
+	}
+
+	void addCell(int slot, int idx) {
+		mark(masks[slot], idx);
+		mark(occupied, idx);
+		zobrist ^= zobristKey(seats[slot], idx);
+
+		const auto& list = BoardTables<N, K>::cellLines[idx];
+		for (int i = 0; i < list.count; ++i) {
+			if (++lineFill[slot][list.ids[i]] == K) ++completeLines[slot];
+		}
+	}
+
+	void removeCell(int slot, int idx) {
+		clear(masks[slot], idx);
+		clear(occupied, idx);
+		zobrist ^= zobristKey(seats[slot], idx);
+
+		const auto& list = BoardTables<N, K>::cellLines[idx];
+		for (int i = 0; i < list.count; ++i) {
+			if (lineFill[slot][list.ids[i]]-- == K) --completeLines[slot];
+		}
+	}
+
+	// -- Mask Access (integer bitboard or std::bitset) --
+	static bool test(const MaskType& m, int idx) {
+		if constexpr (Geometry::bitboard) return (m >> idx) & 1;
+		else return m.test(idx);
+	}
+
+	static void mark(MaskType& m, int idx) {
+		if constexpr (Geometry::bitboard) m |= static_cast<MaskType>(MaskType{ 1 } << idx);
+		else m.set(idx);
+	}
+
+	static void clear(MaskType& m, int idx) {
+		if constexpr (Geometry::bitboard) m &= static_cast<MaskType>(~(MaskType{ 1 } << idx));
+		else m.reset(idx);
+	}
+
+	static bool any(const MaskType& m) {
+		if constexpr (Geometry::bitboard) return m != 0;
+		else return m.any();
+	}
+
+	static int count(const MaskType& m) {
+		if constexpr (!Geometry::bitboard) return static_cast<int>(m.count());
+		else if constexpr (sizeof(MaskType) <= sizeof(unsigned)) return popCount(m);
+		else return popCount64(m);
+	}
+
+	//The mark's own seat unless the other slot's mark already hashes as it
+	int seatFor(char value, int slot) const {
+		int other = any(masks[slot ^ 1]) ? seats[slot ^ 1] : -1;
+		int seat = (value == seatMarks[1]) ? 1 : (value == seatMarks[0]) ? 0 : (other == 0 ? 1 : 0);
+		return seat == other ? seat ^ 1 : seat;
+	}
+
+	//Some slot holds value already, is empty, or only holds idx (which value overwrites)
+	bool canHold(char value, int idx) const {
+		for (int s = 0; s < 2; ++s) {
+			if (!any(masks[s]) || marks[s] == value) return true;
+			if (count(masks[s]) == 1 && test(masks[s], idx)) return true;
+		}
+		return false;
+	}
+
+	//Slot already holding this mark, otherwise the first slot with no cells left
+	int slotFor(char value) {
+		for (int s = 0; s < 2; ++s) {
+			if (marks[s] == value && any(masks[s])) return s;
+		}
+		for (int s = 0; s < 2; ++s) {
+			if (!any(masks[s])) {
+				marks[s] = value;
+				seats[s] = seatFor(value, s);
+				return s;
+			}
+		}
+		assert(false && "set() checks canHold first");
+		return 1;
+	}
+};
+
+using Board = BasicBoard<3, 3>;
+
+// -- Variants --
+using Board4x4 = BasicBoard<4, 4>;
+using GomokuLiteBoard = BasicBoard<5, 4>;	//5x5, four in a row
+using FiveInARowBoard = BasicBoard<15, 5>;	//std::bitset storage
+
+static_assert(Board::fullMask == 0x1FF, "3x3 board keeps the 9-bit Mask");
+static_assert(std::is_same_v<Board::MaskType, Mask>, "3x3 board keeps the 9-bit Mask");
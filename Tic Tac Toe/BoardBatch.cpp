@@ -0,0 +1,228 @@
+#include "BoardBatch.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define TTT_BATCH_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#else
+#define TTT_BATCH_X86 0
+#endif
+
+//GCC/Clang compile the wider kernels for their own target only; MSVC needs no flag
+#if TTT_BATCH_X86 && (defined(__GNUC__) || defined(__clang__))
+#define TTT_TARGET_SSE2 __attribute__((target("sse2")))
+#define TTT_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TTT_TARGET_SSE2
+#define TTT_TARGET_AVX2
+#endif
+
+using namespace std;
+
+
+// ------------- Scalar Kernel -------------
+
+namespace {
+	void evaluateScalar(const Mask* first, const Mask* second, size_t begin, size_t count,
+						int8_t* winner, uint8_t* full, uint8_t* placed) {
+		for (size_t i = begin; i < count; ++i) {
+			Position p;
+			p.marks[0] = first[i];
+			p.marks[1] = second[i];
+			Mask occupied = p.occupied();
+			if (winner) winner[i] = static_cast<int8_t>(winnerOf(p));
+			if (full) full[i] = occupied == Board::fullMask;
+			if (placed) placed[i] = static_cast<uint8_t>(popCount(occupied));
+		}
+	}
+}
+
+
+// ------------- SIMD Kernels -------------
+
+// Both kernels work on 16-bit lanes, one board per lane. For every line in
+// win_lines order, a still-open lane takes seat 0 if seat 0 filled the line,
+// else seat 1 if seat 1 did, matching winnerOf(). Placed counts use a SWAR
+// popcount, so nothing past SSE2/AVX2 is needed.
+
+#if TTT_BATCH_X86
+namespace {
+	TTT_TARGET_SSE2 __m128i popCount16(__m128i x) {
+		x = _mm_sub_epi16(x, _mm_and_si128(_mm_srli_epi16(x, 1), _mm_set1_epi16(0x5555)));
+		x = _mm_add_epi16(_mm_and_si128(x, _mm_set1_epi16(0x3333)), _mm_and_si128(_mm_srli_epi16(x, 2), _mm_set1_epi16(0x3333)));
+		x = _mm_and_si128(_mm_add_epi16(x, _mm_srli_epi16(x, 4)), _mm_set1_epi16(0x0F0F));
+		return _mm_and_si128(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), _mm_set1_epi16(0x001F));
+	}
+
+	TTT_TARGET_SSE2 size_t evaluateSSE2(const Mask* first, const Mask* second, size_t count,
+										int8_t* winner, uint8_t* full, uint8_t* placed) {
+		const __m128i one = _mm_set1_epi16(1);
+		const __m128i fullV = _mm_set1_epi16(static_cast<short>(Board::fullMask));
+
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8) {
+			__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + i));
+			__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(second + i));
+			__m128i occupied = _mm_or_si128(a, b);
+
+			if (winner) {
+				__m128i result = _mm_set1_epi16(-1);
+				__m128i open = _mm_set1_epi16(-1);
+				for (Mask line : win_masks) {
+					__m128i l = _mm_set1_epi16(static_cast<short>(line));
+					__m128i hasA = _mm_and_si128(open, _mm_cmpeq_epi16(_mm_and_si128(a, l), l));
+					__m128i hasB = _mm_andnot_si128(hasA, _mm_and_si128(open, _mm_cmpeq_epi16(_mm_and_si128(b, l), l)));
+					result = _mm_andnot_si128(hasA, result);
+					result = _mm_or_si128(_mm_andnot_si128(hasB, result), _mm_and_si128(hasB, one));
+					open = _mm_andnot_si128(_mm_or_si128(hasA, hasB), open);
+				}
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(winner + i), _mm_packs_epi16(result, result));
+			}
+			if (full) {
+				__m128i f = _mm_and_si128(_mm_cmpeq_epi16(occupied, fullV), one);
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(full + i), _mm_packus_epi16(f, f));
+			}
+			if (placed) {
+				__m128i n = popCount16(occupied);
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(placed + i), _mm_packus_epi16(n, n));
+			}
+		}
+		return i;
+	}
+
+	TTT_TARGET_AVX2 __m256i popCount16(__m256i x) {
+		x = _mm256_sub_epi16(x, _mm256_and_si256(_mm256_srli_epi16(x, 1), _mm256_set1_epi16(0x5555)));
+		x = _mm256_add_epi16(_mm256_and_si256(x, _mm256_set1_epi16(0x3333)), _mm256_and_si256(_mm256_srli_epi16(x, 2), _mm256_set1_epi16(0x3333)));
+		x = _mm256_and_si256(_mm256_add_epi16(x, _mm256_srli_epi16(x, 4)), _mm256_set1_epi16(0x0F0F));
+		return _mm256_and_si256(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), _mm256_set1_epi16(0x001F));
+	}
+
+	//16 lanes down to 16 bytes; the 256-bit packs work per 128-bit half, so pack the halves instead
+	TTT_TARGET_AVX2 void store16(void* out, __m256i v, bool isSigned) {
+		__m128i lo = _mm256_castsi256_si128(v), hi = _mm256_extracti128_si256(v, 1);
+		_mm_storeu_si128(static_cast<__m128i*>(out), isSigned ? _mm_packs_epi16(lo, hi) : _mm_packus_epi16(lo, hi));
+	}
+
+	TTT_TARGET_AVX2 size_t evaluateAVX2(const Mask* first, const Mask* second, size_t count,
+										int8_t* winner, uint8_t* full, uint8_t* placed) {
+		const __m256i one = _mm256_set1_epi16(1);
+		const __m256i fullV = _mm256_set1_epi16(static_cast<short>(Board::fullMask));
+
+		size_t i = 0;
+		for (; i + 16 <= count; i += 16) {
+			__m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first + i));
+			__m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(second + i));
+			__m256i occupied = _mm256_or_si256(a, b);
+
+			if (winner) {
+				__m256i result = _mm256_set1_epi16(-1);
+				__m256i open = _mm256_set1_epi16(-1);
+				for (Mask line : win_masks) {
+					__m256i l = _mm256_set1_epi16(static_cast<short>(line));
+					__m256i hasA = _mm256_and_si256(open, _mm256_cmpeq_epi16(_mm256_and_si256(a, l), l));
+					__m256i hasB = _mm256_andnot_si256(hasA, _mm256_and_si256(open, _mm256_cmpeq_epi16(_mm256_and_si256(b, l), l)));
+					result = _mm256_andnot_si256(hasA, result);
+					result = _mm256_or_si256(_mm256_andnot_si256(hasB, result), _mm256_and_si256(hasB, one));
+					open = _mm256_andnot_si256(_mm256_or_si256(hasA, hasB), open);
+				}
+				store16(winner + i, result, true);
+			}
+			if (full) store16(full + i, _mm256_and_si256(_mm256_cmpeq_epi16(occupied, fullV), one), false);
+			if (placed) store16(placed + i, popCount16(occupied), false);
+		}
+		return i;
+	}
+
+	bool cpuHasAVX2() {
+#if defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 1);
+		bool osSavesYmm = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && ((_xgetbv(0) & 6) == 6);
+		__cpuidex(info, 7, 0);
+		return osSavesYmm && (info[1] & (1 << 5));
+#else
+		return __builtin_cpu_supports("avx2");
+#endif
+	}
+}
+#endif
+
+
+// ------------- Dispatch -------------
+
+bool batchKernelSupported(BatchKernel kernel) {
+	switch (kernel) {
+		case BatchKernel::Auto:
+		case BatchKernel::Scalar:
+			return true;
+#if TTT_BATCH_X86
+		case BatchKernel::SSE2:
+			return true;	//x86-64 baseline
+		case BatchKernel::AVX2: {
+			static const bool avx2 = cpuHasAVX2();
+			return avx2;
+		}
+#endif
+		default:
+			return false;
+	}
+}
+
+BatchKernel bestBatchKernel() {
+	if (batchKernelSupported(BatchKernel::AVX2)) return BatchKernel::AVX2;
+	if (batchKernelSupported(BatchKernel::SSE2)) return BatchKernel::SSE2;
+	return BatchKernel::Scalar;
+}
+
+const char* batchKernelName(BatchKernel kernel) {
+	switch (kernel) {
+		case BatchKernel::Auto: return "auto";
+		case BatchKernel::SSE2: return "sse2";
+		case BatchKernel::AVX2: return "avx2";
+		case BatchKernel::Scalar:
+		default: return "scalar";
+	}
+}
+
+void evaluateBoards(const Mask* first, const Mask* second, size_t count,
+					int8_t* winner, uint8_t* full, uint8_t* placed, BatchKernel kernel) {
+	if (kernel == BatchKernel::Auto) kernel = bestBatchKernel();
+	if (!batchKernelSupported(kernel)) kernel = BatchKernel::Scalar;
+
+	size_t done = 0;
+#if TTT_BATCH_X86
+	if (kernel == BatchKernel::AVX2) done = evaluateAVX2(first, second, count, winner, full, placed);
+	else if (kernel == BatchKernel::SSE2) done = evaluateSSE2(first, second, count, winner, full, placed);
+#endif
+	evaluateScalar(first, second, done, count, winner, full, placed);	//Leftover boards past the last full block
+}
+
+
+// ------------- Board Batch -------------
+
+void BoardBatch::reserve(size_t n) {
+	marks[0].reserve(n);
+	marks[1].reserve(n);
+}
+
+void BoardBatch::clear() {
+	marks[0].clear();
+	marks[1].clear();
+	winner.clear();
+	full.clear();
+	placed.clear();
+}
+
+void BoardBatch::push(Mask first, Mask second) {
+	marks[0].push_back(first);
+	marks[1].push_back(second);
+}
+
+void BoardBatch::evaluate(BatchKernel kernel) {
+	winner.resize(size());
+	full.resize(size());
+	placed.resize(size());
+	evaluateBoards(marks[0].data(), marks[1].data(), size(), winner.data(), full.data(), placed.data(), kernel);
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "Rules.h"
+
+#include <vector>
+
+
+// ------------- Batch Board Evaluation -------------
+
+// Winner, full and placed-count for many 3x3 boards at once. Boards come as a
+// structure of arrays (one mask array per seat) so the kernels stream through
+// them 8 (SSE2) or 16 (AVX2) boards per step with no per-board branches.
+// winner follows winnerOf(): the owner of the first completed line in
+// win_lines order, -1 for none.
+
+enum class BatchKernel {
+	Auto,	//Best one this CPU supports
+	Scalar,
+	SSE2,
+	AVX2
+};
+
+//Kernel Auto resolves to; also what evaluateBoards uses by default
+BatchKernel bestBatchKernel();
+bool batchKernelSupported(BatchKernel kernel);
+const char* batchKernelName(BatchKernel kernel);
+
+//Output arrays hold count entries each; any of them may be nullptr to skip it.
+//An unsupported kernel falls back to Scalar.
+void evaluateBoards(const Mask* first, const Mask* second, size_t count,
+					int8_t* winner, uint8_t* full, uint8_t* placed, BatchKernel kernel = BatchKernel::Auto);
+
+// Owns a block of boards and their results, for callers without their own arrays
+class BoardBatch {
+public:
+	void reserve(size_t n);
+	void clear();
+	size_t size() const { return marks[0].size(); }
+
+	void push(Mask first, Mask second);
+	void push(const Position& p) { push(p.marks[0], p.marks[1]); }
+	void push(const Board& b, char firstMark, char secondMark) { push(b.maskFor(firstMark), b.maskFor(secondMark)); }
+
+	//Fills winner/full/placed for every pushed board
+	void evaluate(BatchKernel kernel = BatchKernel::Auto);
+
+	std::vector<Mask> marks[2];
+	std::vector<int8_t> winner;
+	std::vector<uint8_t> full;
+	std::vector<uint8_t> placed;
+};
@@ -0,0 +1,542 @@
+#include "Console.h"
+
+#include <iostream>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+using namespace std;
+
+
+// ------------- Console Input -------------
+
+namespace {
+	struct ConsoleFeed {
+		shared_ptr<InputChannel> channel = make_shared<InputChannel>();
+		InputLoop loop;
+		bool reading = false;	//stdin added and the loop running
+	};
+
+	ConsoleFeed& consoleFeed() {
+		static ConsoleFeed feed;
+		return feed;
+	}
+}
+
+InputChannel& consoleInput() {
+	ConsoleFeed& feed = consoleFeed();
+	if (!feed.reading) {
+		feed.reading = true;
+		feed.loop.addFd(0, feed.channel);
+		feed.loop.start();
+	}
+	return *feed.channel;
+}
+
+void queueConsoleScript(vector<string> lines, int intervalMs) {
+	ConsoleFeed& feed = consoleFeed();
+	feed.loop.addScript(move(lines), feed.channel, intervalMs);
+}
+
+bool loadConsoleScript(const string& path) {
+	ConsoleFeed& feed = consoleFeed();
+	string text;
+	char chunk[1 << 16];
+	if (path == "-") {
+		size_t got;
+		while ((got = fread(chunk, 1, sizeof(chunk), stdin)) > 0) text.append(chunk, got);
+		feed.reading = true;	//stdin is used up, nothing follows the script
+		feed.channel->pushText(text);
+		feed.channel->close();
+		return true;
+	}
+
+	//Chunks to the end rather than seeking for the size, so pipes and <(...) work too
+	ifstream file(path, ios::binary);
+	if (!file) return false;
+	while (file.read(chunk, sizeof(chunk)) || file.gcount() > 0) text.append(chunk, static_cast<size_t>(file.gcount()));
+	if (file.bad()) return false;
+	feed.channel->pushText(text);
+	return true;
+}
+
+string readConsoleLine() {
+	string line;
+	readConsoleLine(line, noDeadline);
+	return line;
+}
+
+bool readConsoleLine(string& line, InputDeadline deadline) {
+	TTT_PROFILE_SCOPE(InputWait);
+	//Queued answers (scripts, piped input) need no flush; only show the prompt before waiting
+	InputChannel& input = consoleInput();
+	InputStatus status = input.tryRead(line);
+	if (status == InputStatus::Timeout) {
+		cout.flush();
+		status = input.readUntil(line, deadline);
+	}
+	if (status == InputStatus::Closed) {
+		cout << "\nInput closed. Exiting.\n";
+		exit(0);
+	}
+	return status == InputStatus::Line;
+}
+
+bool readConsoleInt(int& value) {
+	string line;
+	do {
+		line = readConsoleLine();
+	} while (line.find_first_not_of(" \t\r") == string::npos);
+
+	istringstream in(line);
+	return static_cast<bool>(in >> value);
+}
+
+
+// ------------- Utility Input Helpers -------------
+
+int parseMove(string_view raw, int cells) {
+	//Whitespace anywhere is dropped, so "1 0" reads as 10
+	int length = 0, digits = 0;
+	char first = '\0';
+	bool numeric = true, negative = false;
+	int n = 0;
+	for (unsigned char c : raw) {
+		if (isspace(c)) continue;
+		if (length++ == 0) {
+			first = static_cast<char>(c);
+			if (c == '+' || c == '-') {
+				negative = (c == '-');
+				continue;
+			}
+		}
+		if (!isdigit(c)) {
+			numeric = false;
+			continue;
+		}
+		++digits;
+		if (n <= cells) n = n * 10 + (c - '0');	//Anything past cells is out of range already
+	}
+	if (length == 0) return -1;
+
+	if (length == 1) {
+		char c = static_cast<char>(tolower(static_cast<unsigned char>(first)));
+		if (c >= 'a' && c < 'a' + cells && c <= 'z') return c - 'a'; // a=0 ... i=8
+	}
+
+	if (!numeric || digits == 0 || negative) return -1;
+	return (1 <= n && n <= cells) ? n - 1 : -1;
+}
+
+bool parseInt(string_view text, int& value, int lo, int hi) {
+	int n = 0;
+	auto [end, error] = from_chars(text.data(), text.data() + text.size(), n);
+	if (text.empty() || error != errc() || end != text.data() + text.size() || n < lo || n > hi) return false;
+	value = n;
+	return true;
+}
+
+bool parseUint64(string_view text, uint64_t& value) {
+	uint64_t n = 0;
+	auto [end, error] = from_chars(text.data(), text.data() + text.size(), n);
+	if (text.empty() || error != errc() || end != text.data() + text.size()) return false;
+	value = n;
+	return true;
+}
+
+bool parseDouble(string_view text, double& value) {
+	string copy(text);	//strtod wants a terminated string
+	char* end = nullptr;
+	double n = strtod(copy.c_str(), &end);
+	if (copy.empty() || isspace(static_cast<unsigned char>(copy[0])) || end != copy.c_str() + copy.size() || !isfinite(n)) return false;
+	value = n;
+	return true;
+}
+
+int promptMove(const Board& b, char playerMark, const string& label, char hintOpponent, InputDeadline deadline) {
+	string range;
+	Board::appendCellRange(range);
+	while (true) {
+		cout << label << " (" << playerMark << "), choose a cell (" << range
+			<< (hintOpponent != '\0' ? ", h for hint" : "") << "): ";
+
+		string line;
+		if (!readConsoleLine(line, deadline)) return -1;
+
+		if (hintOpponent != '\0' && (line == "h" || line == "H")) {
+			int best = Solver::instance().bestMove(b, playerMark, hintOpponent);
+			if (best == -1) {
+				cout << "  No hint available.\n";
+			}
+			else {
+				cout << "  Hint: the best move is cell " << (best + 1) << ".\n";
+			}
+			continue;
+		}
+
+		int idx = parseMove(line, Board::cells);
+		if (idx == -1) {
+			cout << "  Invalid input. Please enter " << range << ".\n";
+			continue;
+		}
+
+		if (b.get(idx) != ' ') {
+			cout << "  That space is already taken. Choose another.\n";
+			continue;
+		}
+
+		return idx;
+	}
+}
+
+bool isAllowedMark(char c) {
+	if (isalpha(static_cast<unsigned char>(c))) return true;	//A-Z, a-z
+	switch (c) { case '?': case '!': case '*': case '~': case '$': case '%': case '#': return true;
+	default:
+		return false;
+	}
+}
+
+char promptMark(const string& playerLabel, char forbidden) {
+	while (true) {
+		cout << playerLabel << ", choose your mark (One Char: A-Z, a-z, ?, !, *, ~, $, %, #): ";
+		string s = readConsoleLine();
+
+		if (s.size() != 1) {
+			cout << "Please enter exactly one Character.\n";
+			continue;
+		}
+
+		char c = s[0];
+		if (!isAllowedMark(c)) {
+			cout << "\tThat Character is not allowed.\n";
+			continue;
+		}
+		if (isspace(static_cast<unsigned char>(c))) {
+			cout << "\tSpace is not allowed.\n";
+			continue;
+		}
+		if (forbidden != '\0' && c == forbidden) {
+			cout << "\tThat Mark is already taken by the other player.\n";
+			continue;
+		}
+
+		return c;
+	}
+}
+
+string promptArch(const string& playerLabel) {
+	while (true) {
+		cout << playerLabel << ", choose your Archetype (Alchemist / Paladin): ";
+		string s = readConsoleLine();
+
+		string lower;
+		for (char c : s) {
+			lower += static_cast<char>(tolower(static_cast<unsigned char>(c)));
+		}
+
+		if (lower == "paladin" || lower == "alchemist") { return lower; }
+
+		cout << "\tInvalid Archetype. Please enter either Paladin or Alchemist.\n";
+	}
+}
+
+int promptAnyOccupiedIdx(const Board& b, const string& msg, InputDeadline deadline) {
+	while (true) {
+		cout << msg;
+		string s;
+		if (!readConsoleLine(s, deadline)) return -1;
+
+		int idx = parseMove(s);
+		if (idx == -1) {
+			cout << "Invalid Cell.\n";
+			continue;
+		}
+
+		if (b.get(idx) == ' ') {
+			cout << "\tThat Cell is Empty.\n";
+			continue;
+		}
+
+		return idx;
+	}
+}
+
+int promptAnyIdx(const string& msg, InputDeadline deadline) {
+	while (true) {
+		cout << msg;
+		string s;
+		if (!readConsoleLine(s, deadline)) return -1;
+
+		int idx = parseMove(s);
+		if (idx == -1) {
+			cout << "Invalid Cell.\n";
+			continue;
+		}
+
+		return idx;
+	}
+}
+
+
+string describeAction(const Action& action) {
+	switch (action.type) {
+	case ActionType::Swap:  return "swaps cells " + to_string(action.a + 1) + " and " + to_string(action.b + 1) + ".";
+	case ActionType::Shift: return "shifts cell " + to_string(action.a + 1) + " to " + to_string(action.b + 1) + ".";
+	case ActionType::Place:
+	default:                return "places on cell " + to_string(action.a + 1) + ".";
+	}
+}
+
+string actionErrorMessage(const Action& action, ActionError error) {
+	bool swap = (action.type == ActionType::Swap);
+	switch (error) {
+	case ActionError::None:			return "";
+	case ActionError::OutOfRange:	return "Invalid Cell.\n";
+	case ActionError::NotAllowed:	return "\tInvalid Choice.\n";
+	case ActionError::CellEmpty:	return "\tThat Cell is Empty.\n";
+	case ActionError::CellOccupied:
+		return (action.type == ActionType::Place) ? "  That space is already taken. Choose another.\n" : "Destination must be empty.\n";
+	case ActionError::TooFewMarks:
+		return swap ? "You can't swap yet, you need at least two marks on the board to swap.\n"
+			: "\tYou can't shift yet, you need at least one mark on the board to shift.\n";
+	case ActionError::SameCell:
+		return swap ? "You chose the same cell twice.\n" : " Destination must be different.\n";
+	case ActionError::SameMarks:	return "\tThose Match-Swaps would be Pointless.\n";
+	case ActionError::NotAdjacent:	return " Destination is not adjacent.\n";
+	}
+	return "\tInvalid Choice.\n";
+}
+
+
+// ------------- Console Front End -------------
+
+Action ConsolePlayerController::chooseAction(const Observation& obs) {
+	//The clock covers the whole turn, retries and sub-prompts included
+	InputDeadline deadline = noDeadline;
+	if (turnClockMs > 0) deadline = chrono::steady_clock::now() + chrono::milliseconds(turnClockMs);
+
+	if (obs.battleRules) {
+		return chooseBattleAction(obs, deadline);
+	}
+	int idx = promptMove(obs.board, obs.self.mark, obs.self.name, hints ? obs.opponent.mark : '\0', deadline);
+	return (idx == -1) ? timeUp(obs) : Action::place(idx);
+}
+
+void ConsolePlayerController::onRejected(const Observation&, const Action& action, ActionError error) {
+	cout << actionErrorMessage(action, error);
+}
+
+Action ConsolePlayerController::timeUp(const Observation& obs) {
+	int cell = 0;
+	while (cell < Board::cells - 1 && obs.board.get(cell) != ' ') ++cell;
+	cout << "\n  Time's up! " << obs.self.name << " places on cell " << (cell + 1) << ".\n";
+	return Action::place(cell);
+}
+
+Action ConsolePlayerController::chooseBattleAction(const Observation& obs, InputDeadline deadline) {
+	const Board& board = obs.board;
+	const Player& player = obs.self;
+
+	while (true) {
+		cout << player.name << " (" << player.mark << ") - Choose Action:\n";
+		cout << " 1) Regular Move\n";
+		if (player.archetype == Archetype::Alchemist) {
+			cout << " 2) Alchemist: swap two marks\n";
+		}
+		if (player.archetype == Archetype::Paladin) {
+			cout << " 2) Paladin: shift a mark to an adjactent empty cell\n";
+		}
+		cout << "Select: ";
+
+		string s;
+		if (!readConsoleLine(s, deadline)) return timeUp(obs);
+
+		Action action;
+
+		//Regular Move
+		if (s == "1") {
+			int idx = promptMove(board, player.mark, player.name, '\0', deadline);
+			return (idx == -1) ? timeUp(obs) : Action::place(idx);
+		}
+
+		//Alchemist Check/Move
+		else if (s == "2" && player.archetype == Archetype::Alchemist) {
+			if (board.countPlaced() < 2) {
+				cout << actionErrorMessage(Action::swap(-1, -1), ActionError::TooFewMarks);
+				continue;
+			}
+
+			int a = promptAnyOccupiedIdx(board, " Choose first occupied cell to swap: ", deadline);
+			int b = (a == -1) ? -1 : promptAnyOccupiedIdx(board, " Choose second occupied cell to swap: ", deadline);
+			if (b == -1) return timeUp(obs);
+			action = Action::swap(a, b);
+		}
+
+		//Paladin Check/Move
+		else if (s == "2" && player.archetype == Archetype::Paladin) {
+			if (board.countPlaced() < 1) {
+				cout << actionErrorMessage(Action::shift(-1, -1), ActionError::TooFewMarks);
+				continue;
+			}
+
+			int from = promptAnyOccupiedIdx(board, " Choose an occupied cell to shift: ", deadline);
+			int to = (from == -1) ? -1 : promptAnyIdx("\tChoose a cell to shift to: ", deadline);
+			if (to == -1) return timeUp(obs);
+			action = Action::shift(from, to);
+		}
+		else {
+			cout << "\tInvalid Choice.\n";
+			continue;
+		}
+
+		//Swap/Shift Error Checks
+		ActionError error = validateAction(board, action, player.archetype);
+		if (error != ActionError::None) {
+			cout << actionErrorMessage(action, error);
+			continue;
+		}
+		return action;
+	}
+}
+
+void BoardRenderer::draw(const Board& board) {
+	if (mode == RenderMode::Off) return;
+	TTT_PROFILE_SCOPE(Render);
+
+	frame.clear();
+	if (mode == RenderMode::Full) {
+		board.formatBoard(frame);
+	}
+	else if (!pinned) {
+		frame += "\x1b[2J\x1b[H";		//Clear, cursor home
+		board.formatBoard(frame);
+		frame += "\x1b[";
+		frame += to_string(frameRows + 1);
+		frame += "r";					//Scroll region below the board (moves the cursor home)
+		appendCursor(frameRows + 1, 1);
+		pinned = true;
+	}
+	else {
+		for (int idx = 0; idx < Board::cells; ++idx) {
+			if (board.get(idx) == shown[idx]) continue;
+			if (frame.empty()) frame += "\x1b" "7";	//Save cursor
+			appendCursor(2 + 2 * (idx / Board::size), 2 + (idx % Board::size) * (Board::cellWidth + 3));
+			board.appendCell(frame, idx);
+		}
+		if (!frame.empty()) frame += "\x1b" "8";		//Restore cursor
+	}
+
+	for (int idx = 0; idx < Board::cells; ++idx) shown[idx] = board.get(idx);
+	if (frame.empty()) return;
+
+	out.write(frame.data(), static_cast<streamsize>(frame.size()));
+	out.flush();
+}
+
+void BoardRenderer::release() {
+	if (!pinned) return;
+	out << "\x1b[r\x1b[999;1H";		//Whole screen scrolls again, cursor to the bottom
+	pinned = false;
+}
+
+void BoardRenderer::appendCursor(int row, int col) {
+	frame += "\x1b[";
+	frame += to_string(row);
+	frame += ';';
+	frame += to_string(col);
+	frame += 'H';
+}
+
+void ConsoleMatchView::onTurnStart(const Board& board, const Player&) {
+	renderer.draw(board);
+}
+
+void ConsoleMatchView::onAction(const Board&, const Player& player, int seat, const Action& action) {
+	if (announce[seat]) {
+		cout << player.name << " (" << player.mark << ") " << describeAction(action) << "\n";
+	}
+}
+
+void ConsoleMatchView::onGameOver(const Board& board, const GameOutcome& outcome) {
+	renderer.draw(board);
+	if (!announceResult) return;
+
+	if (outcome.winnerSeat != -1) {
+		cout << outcome.winnerMark << " won\n\n";
+	}
+	else {
+		cout << "Tie\n";
+	}
+}
+
+bool ConsoleCampaignController::continueSavedCampaign(const Player&, int) {
+	cout << "Continue this campaign? (y/n): ";
+	string ans = readConsoleLine();
+	return !ans.empty() && (ans[0] == 'y' || ans[0] == 'Y');
+}
+
+void ConsoleCampaignController::createHero(string& name, Archetype& archetype) {
+	cout << "Enter your Hero's name: ";
+	name = readConsoleLine();
+
+	string arch = promptArch(name.empty() ? "Hero" : name);
+	archetype = (arch == "paladin") ? Archetype::Paladin : Archetype::Alchemist;
+}
+
+EnemyStrategy ConsoleCampaignController::chooseEnemyStrategy() {
+	while (true) {
+		cout << "Enemy difficulty (1 Random, 2 Perfect, 3 Tiered, 4 MCTS): ";
+		string s = readConsoleLine();
+
+		if (s == "1") return EnemyStrategy::Random;
+		if (s == "2") return EnemyStrategy::Perfect;
+		if (s == "3") return EnemyStrategy::Tiered;	//Stronger foes think harder
+		if (s == "4") return EnemyStrategy::Mcts;
+
+		cout << "\tPlease enter 1, 2, 3 or 4.\n";
+	}
+}
+
+bool ConsoleCampaignController::quitBeforeBattle(int) {
+	int isQuit = 0;
+	cout << "Continue on or Quit? (1 Quit, 0 Continue) ";
+	if (!readConsoleInt(isQuit)) {
+		cout << "Invalid input, continuing the battle.\n";
+		isQuit = 0;
+	}
+	return isQuit == 1;
+}
+
+CampaignPath ConsoleCampaignController::choosePath() {
+	while (true) {
+		cout << "\nChoose Path:\n"
+			<< " Wandered  (Less Dangerous, Less Rewards)\n"
+			<< " Wilderness  (More Danergous, More Rewards)\n"
+			<< "Enter Path: ";
+
+		string choice = readConsoleLine();
+
+		string lower;
+		for (char c : choice) {
+			lower += static_cast<char>(tolower(static_cast<unsigned char>(c)));
+		}
+
+		if (lower == "wandered") return CampaignPath::Wandered;
+		if (lower == "wilderness") return CampaignPath::Wilderness;
+
+		cout << "Please enter either: Wandered or Wilderness.\n";
+	}
+}
+
+bool ConsoleCampaignController::touchShrine() {
+	cout << "Do you touch the altar? (y/n): ";
+
+	string input = readConsoleLine();
+
+	return !input.empty() && (input[0] == 'y' || input[0] == 'Y');
+}
@@ -0,0 +1,161 @@
+#pragma once
+
+#include "Engine.h"
+#include "Input.h"
+
+#include <array>
+#include <climits>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+// ------------- Console Input -------------
+
+// Every prompt reads from one channel, fed off the main thread by an
+// InputLoop polling stdin (a terminal or a pipe) behind any scripted lines.
+InputChannel& consoleInput();
+
+//Lines answered before anything typed; call before the first prompt
+void queueConsoleScript(std::vector<std::string> lines, int intervalMs = 0);
+
+//Reads a whole script of answers in one go and queues it the same way.
+//"-" takes all of stdin instead, so input ends where the script does.
+bool loadConsoleScript(const std::string& path);
+
+//Next line; once input has ended, says so and exits like every prompt always did
+std::string readConsoleLine();
+
+//As above, false if the deadline passes first
+bool readConsoleLine(std::string& line, InputDeadline deadline);
+
+//Skips blank lines and reads a leading integer, false when the line has none
+bool readConsoleInt(int& value);
+
+
+// ------------- Utility Input Helpers -------------
+
+//1-cells or a letter (boards up to 26 cells), -1 when invalid
+int parseMove(std::string_view raw, int cells = Board::cells);
+
+//Command-line values: the whole text must be the number, and within [lo, hi] for ints.
+//False (value untouched) otherwise, so a typo is reported instead of throwing.
+bool parseInt(std::string_view text, int& value, int lo = INT_MIN, int hi = INT_MAX);
+bool parseUint64(std::string_view text, uint64_t& value);
+bool parseDouble(std::string_view text, double& value);	//Finite values only
+
+//Passing the opponent's mark enables the 'h' hint command.
+//The cell prompts return -1 when the deadline passes.
+int promptMove(const Board& b, char playerMark, const std::string& label, char hintOpponent = '\0', InputDeadline deadline = noDeadline);
+
+bool isAllowedMark(char c);
+char promptMark(const std::string& playerLabel, char forbidden = '\0');
+std::string promptArch(const std::string& playerLabel);
+int promptAnyOccupiedIdx(const Board& b, const std::string& msg, InputDeadline deadline = noDeadline);
+int promptAnyIdx(const std::string& msg, InputDeadline deadline = noDeadline);
+
+//"places on cell 5." / "swaps cells 1 and 3." / "shifts cell 1 to 2."
+std::string describeAction(const Action& action);
+
+//Console wording for a refused action
+std::string actionErrorMessage(const Action& action, ActionError error);
+
+
+// ------------- Console Front End -------------
+
+// A human at the keyboard: plain moves for Regular/Campaign, the action menu for Battle.
+// With a turn clock, running out of time places on the first free cell.
+class ConsolePlayerController : public PlayerController {
+public:
+	explicit ConsolePlayerController(bool hints = false) : hints(hints) {}
+
+	//Picked by main() from --turn-clock, 0 = untimed
+	static inline int defaultTurnClockMs = 0;
+	int turnClockMs = defaultTurnClockMs;
+
+	Action chooseAction(const Observation& obs) override;
+	void onRejected(const Observation& obs, const Action& action, ActionError error) override;
+
+private:
+	bool hints;
+
+	Action chooseBattleAction(const Observation& obs, InputDeadline deadline);
+	Action timeUp(const Observation& obs);
+};
+
+// ------------- Board Renderer -------------
+
+enum class RenderMode {
+	Off,	//Draw nothing (headless and piped runs)
+	Full,	//The whole frame every time, same text as printBoard()
+	Diff	//Board pinned to the top of the terminal, only changed cells redrawn (ANSI)
+};
+
+// Formats each frame into one reusable buffer and sends it in a single write.
+// Diff mode clears the screen once, keeps the board above a scroll region so
+// prompts and narration scroll underneath it, then only moves the cursor to
+// the cells that changed.
+class BoardRenderer {
+public:
+	explicit BoardRenderer(std::ostream& out, RenderMode mode = defaultMode) : out(out), mode(mode) {}
+	~BoardRenderer() { release(); }
+
+	BoardRenderer(const BoardRenderer&) = delete;
+	BoardRenderer& operator=(const BoardRenderer&) = delete;
+
+	//Picked by main() from --render, used by every renderer created afterwards
+	static inline RenderMode defaultMode = RenderMode::Full;
+
+	void draw(const Board& board);
+
+	//Gives the screen back (resets the scroll region); the next draw starts over
+	void release();
+
+	RenderMode getMode() const { return mode; }
+
+private:
+	std::ostream& out;
+	RenderMode mode;
+	std::string frame;
+	std::array<char, Board::cells> shown{};	//Cell contents currently on screen
+	bool pinned = false;
+
+	//Screen rows used by formatBoard(), the scroll region starts below them
+	static constexpr int frameRows = 2 * Board::size + 3;
+
+	void appendCursor(int row, int col);
+};
+
+
+// Prints the board each turn and, for computer seats, what they played
+class ConsoleMatchView : public MatchListener {
+public:
+	bool announce[2] = { false, false };	//Describe this seat's actions
+	bool announceResult = true;				//"X won" / "Tie" at the end
+	BoardRenderer renderer{ std::cout };
+
+	void onTurnStart(const Board& board, const Player& player) override;
+	void onAction(const Board& board, const Player& player, int seat, const Action& action) override;
+	void onGameOver(const Board& board, const GameOutcome& outcome) override;
+};
+
+class ConsoleCampaignController : public CampaignController {
+public:
+	ConsoleCampaignController() { roundView.announce[1] = true; roundView.announceResult = false; }
+
+	bool continueSavedCampaign(const Player& hero, int stage) override;
+	void createHero(std::string& name, Archetype& archetype) override;
+	EnemyStrategy chooseEnemyStrategy() override;
+	bool quitBeforeBattle(int stage) override;
+	CampaignPath choosePath() override;
+	bool touchShrine() override;
+
+	PlayerController& heroController() override { return hero; }
+	MatchListener* roundListener() override { return &roundView; }
+
+private:
+	ConsolePlayerController hero;
+	ConsoleMatchView roundView;
+};
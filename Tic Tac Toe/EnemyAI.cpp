@@ -0,0 +1,121 @@
+#include "EnemyAI.h"
+
+using namespace std;
+
+
+// ------------- Enemy Search -------------
+
+int EnemySearch::bestMove(const Board& b, char mover, char opponent, int maxDepth, double budgetMs) {
+	Mask own = b.maskFor(mover), other = b.maskFor(opponent);
+	Mask empty = static_cast<Mask>(~(own | other) & Board::fullMask);
+	if (!empty) return -1;
+
+	if (table.empty()) table = TranspositionCache<Entry>(Solver::positions);
+	if (++stamp == 0) {
+		//Stamps wrapped, old entries could look current again
+		table.clear();
+		stamp = 1;
+	}
+
+	nodes = 0;
+	timed = false;
+	timedOut = false;
+	lastTimedOut = false;
+	auto start = chrono::steady_clock::now();
+	deadline = start + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double, milli>(budgetMs));
+
+	int depthLimit = min(maxDepth, popCount(empty));
+	int best = -1;
+	Canonical root = canonicalize(own, other);
+	for (int depth = 1; depth <= depthLimit; ++depth) {
+		timed = budgetMs > 0 && depth > 1;
+		int score = negamax(own, other, depth, -winScore - 10, winScore + 10);
+		if (timedOut) {
+			lastTimedOut = true;
+			break;
+		}
+
+		best = root.cellFromCanonical(table.at(root.code).move);
+		lastScore = score;
+		lastDepth = depth;
+		if (score >= winScore || score <= -winScore) break; //Forced result found
+	}
+	return best;
+}
+
+//Open lines weighted by how many marks they already hold
+int EnemySearch::evaluate(Mask mover, Mask opponent) {
+	int score = 0;
+	for (Mask line : win_masks) {
+		int mine = popCount(mover & line), theirs = popCount(opponent & line);
+		if (theirs == 0) score += mine * mine;
+		if (mine == 0) score -= theirs * theirs;
+	}
+	return score;
+}
+
+//The opponent just moved without winning; wins score higher the sooner they come
+int EnemySearch::negamax(Mask mover, Mask opponent, int depth, int alpha, int beta) {
+	++nodes;
+	if (timed && (nodes & 255) == 0 && chrono::steady_clock::now() >= deadline) timedOut = true;
+	if (timedOut) return 0;
+
+	Mask empty = static_cast<Mask>(~(mover | opponent) & Board::fullMask);
+	if (!empty) return 0;
+	if (depth == 0) return evaluate(mover, opponent);
+
+	Canonical c = canonicalize(mover, opponent);
+	Entry& e = table.at(c.code);
+	bool known = e.stamp == stamp;
+	if (known && e.depth >= depth) {
+		if (e.flag == Exact) return e.score;
+		if (e.flag == Lower && e.score >= beta) return e.score;
+		if (e.flag == Upper && e.score <= alpha) return e.score;
+	}
+
+	//Stored best move first, then the rest in cell order
+	int first = known ? c.cellFromCanonical(e.move) : -1;
+	int remaining = popCount(empty) - 1;
+	int alphaStart = alpha;
+	int best = -winScore - 10;
+	int bestCell = -1;
+
+	for (int n = -1; n < 9; ++n) {
+		int i = (n == -1) ? first : n;
+		if (i < 0 || (n >= 0 && i == first) || !(empty & cellBit(i))) continue;
+
+		Mask next = static_cast<Mask>(mover | cellBit(i));
+		int score = completesLineThrough(next, i) ? winScore + remaining : -negamax(opponent, next, depth - 1, -beta, -alpha);
+		if (timedOut) return 0;
+
+		if (score > best) {
+			best = score;
+			bestCell = i;
+		}
+		if (best > alpha) alpha = best;
+		if (alpha >= beta) break;
+	}
+
+	e.score = static_cast<int16_t>(best);
+	e.depth = static_cast<int8_t>(depth);
+	e.move = static_cast<int8_t>(transformCell(bestCell, c.symmetry));
+	e.flag = (best <= alphaStart) ? Upper : (best >= beta) ? Lower : Exact;
+	e.stamp = stamp;
+	return best;
+}
+
+
+// ------------- Greedy -------------
+
+int greedyCell(const Board& b, char mover, char opponent) {
+	Mask own = b.maskFor(mover), other = b.maskFor(opponent);
+	Mask empty = b.maskFor(' ');
+
+	for (int i = 0; i < 9; ++i) {
+		if ((empty & cellBit(i)) && completesLineThrough(static_cast<Mask>(own | cellBit(i)), i)) return i;
+	}
+	for (int i = 0; i < 9; ++i) {
+		if ((empty & cellBit(i)) && completesLineThrough(static_cast<Mask>(other | cellBit(i)), i)) return i;
+	}
+	return -1;
+}
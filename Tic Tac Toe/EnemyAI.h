@@ -0,0 +1,52 @@
+#pragma once
+
+#include "Symmetry.h"
+
+#include <chrono>
+
+
+// ------------- Enemy Search -------------
+
+// Depth-limited alpha-beta over plain placements, for campaign enemies that
+// should play well but not perfectly. Iterative deepening stops at maxDepth
+// or, given a budget, when it runs out, keeping the move from the last
+// finished depth; depth 1 always finishes. Campaign enemies pass no budget,
+// since a full 3x3 search is cheap and a clock would break replays.
+// The table is keyed by canonical code and stamped per move, so the answer
+// depends only on the position and the depth reached.
+class EnemySearch {
+public:
+	static constexpr int winScore = 100;
+
+	//-1 when the board has no empty cell; budgetMs <= 0 = no time limit
+	int bestMove(const Board& b, char mover, char opponent, int maxDepth, double budgetMs);
+
+	int lastScore = 0;			//From the mover's point of view
+	int lastDepth = 0;			//Deepest finished iteration
+	bool lastTimedOut = false;
+	uint64_t nodes = 0;
+
+private:
+	enum : uint8_t { Exact, Lower, Upper };
+
+	struct Entry {
+		int16_t score = 0;
+		int8_t depth = -1;
+		int8_t move = -1;		//Canonical orientation
+		uint8_t flag = Exact;
+		uint16_t stamp = 0;		//Entry belongs to the move with this stamp
+	};
+
+	TranspositionCache<Entry> table{ 0 };
+	uint16_t stamp = 0;
+
+	std::chrono::steady_clock::time_point deadline;
+	bool timed = false;
+	bool timedOut = false;
+
+	static int evaluate(Mask mover, Mask opponent);
+	int negamax(Mask mover, Mask opponent, int depth, int alpha, int beta);
+};
+
+//Cell that wins on the spot, else one that blocks the opponent's win, else -1
+int greedyCell(const Board& b, char mover, char opponent);
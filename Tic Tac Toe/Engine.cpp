@@ -0,0 +1,931 @@
+#include "Engine.h"
+#include "EnemyAI.h"
+#include "Mcts.h"
+#include "Replay.h"
+#include "SaveFile.h"
+#include "SaveStore.h"
+
+#include <functional>
+#include <random>
+#include <thread>
+
+using namespace std;
+
+
+// ------------- Enemy Strategies -------------
+
+int randomEmptyCell(const Board& board, Rng& gen) {
+	Mask empty = board.maskFor(' ');
+	if (!empty) {
+		return -1; //No Move Possible
+	}
+
+	//Drop the lowest empty cells until the chosen one is the lowest left
+	for (uint32_t skip = gen.below(static_cast<uint32_t>(popCount(empty))); skip; --skip) {
+		empty &= empty - 1;
+	}
+	return popCount(static_cast<unsigned>((empty & -empty) - 1));
+}
+
+int randomEmptyCell(const Board& board) {
+	return randomEmptyCell(board, globalRng());
+}
+
+int chooseEnemyCell(const Board& board, EnemyStrategy strategy, char enemyMark, char heroMark, Rng& gen, int searchDepth) {
+	int idx = -1;
+	switch (strategy) {
+		case EnemyStrategy::Perfect:
+			idx = Solver::instance().bestMove(board, enemyMark, heroMark);
+			break;
+		case EnemyStrategy::Greedy:
+			idx = greedyCell(board, enemyMark, heroMark);
+			break;
+		case EnemyStrategy::Search: {
+			thread_local EnemySearch search;	//Table reused between moves, results don't carry over; depth only,
+												//never the clock, so a replay reaches the same depth
+			idx = search.bestMove(board, enemyMark, heroMark, searchDepth, 0);
+			break;
+		}
+		case EnemyStrategy::Mcts: {
+			thread_local MctsSearch search;		//Arena reused between moves; iterations only, never the clock,
+												//so a recorded campaign replays the same moves on any machine
+			const Archetype places[2] = { Archetype::None, Archetype::None };
+			idx = search.bestAction(Position::fromBoard(board, enemyMark, heroMark, 0), places, gen()).a;
+			break;
+		}
+		default:
+			break;
+	}
+	if (idx != -1) return idx;
+	return randomEmptyCell(board, gen);
+}
+
+//Weakest foes first; the later a stage, the sharper its guard
+EnemyTier enemyTierFor(EnemyAbility signature, int stage, int bossDepth) {
+	bool late = stage >= 5;
+	switch (signature) {
+		case EnemyAbility::BrittleBones:	//Skeleton
+			return { late ? EnemyStrategy::Greedy : EnemyStrategy::Random, 0 };
+		case EnemyAbility::ThickSkin:		//Zombie
+			return late ? EnemyTier{ EnemyStrategy::Search, 2 } : EnemyTier{ EnemyStrategy::Greedy, 0 };
+		case EnemyAbility::Corporeal:		//Ghost
+			return { EnemyStrategy::Search, late ? 4 : 2 };
+		case EnemyAbility::Opening:			//Necromancer Halut
+			return { EnemyStrategy::Search, bossDepth };
+		default:
+			return { EnemyStrategy::Random, 0 };
+	}
+}
+
+
+// -- Random Number Gen --
+
+Rng& globalRng() {
+	thread_local Rng gen(random_device{}(), hash<thread::id>{}(this_thread::get_id()));
+	return gen;
+}
+
+int randomInt(Rng& gen, int min, int max) {
+	return min + static_cast<int>(gen.below(static_cast<uint32_t>(max - min + 1)));
+}
+
+int randomInt(int min, int max) {
+	return randomInt(globalRng(), min, max);
+}
+
+
+// ------------- Controllers -------------
+
+Action StrategyController::chooseAction(const Observation& obs) {
+	return Action::place(chooseEnemyCell(obs.board, strategy, obs.self.mark, obs.opponent.mark, rng ? *rng : globalRng(), searchDepth));
+}
+
+Action RandomController::chooseAction(const Observation& obs) {
+	Archetype arch = obs.battleRules ? obs.self.archetype : Archetype::None;
+	ActionList legal;
+	generateActions(Position::fromBoard(obs.board, obs.self.mark, obs.opponent.mark, 0), arch, legal);
+	return legal.moves[(rng ? *rng : globalRng()).below(static_cast<uint32_t>(legal.count))];
+}
+
+Action BattleAIController::chooseAction(const Observation& obs) {
+	Archetype own = obs.battleRules ? obs.self.archetype : Archetype::None;
+	Archetype other = obs.battleRules ? obs.opponent.archetype : Archetype::None;
+	Archetype seats[2] = { obs.seat == 0 ? own : other, obs.seat == 0 ? other : own };
+
+	if (!ready || seats[0] != archetypes[0] || seats[1] != archetypes[1]) {
+		archetypes[0] = seats[0];
+		archetypes[1] = seats[1];
+		search.reset(seats[0], seats[1], depth);
+		ready = true;
+	}
+
+	char mark0 = (obs.seat == 0) ? obs.self.mark : obs.opponent.mark;
+	char mark1 = (obs.seat == 0) ? obs.opponent.mark : obs.self.mark;
+	return search.bestMove(Position::fromBoard(obs.board, mark0, mark1, obs.seat));
+}
+
+
+// ------------- Base Game Class -------------
+
+GameOutcome TicTacToeGame::run() {
+	board.clearBoard();
+	turn = 0;
+	setupPlayers();
+	board.setSeatMarks(players[0].mark, players[1].mark);
+	if (replay && replayStandalone) replay->beginMatch(players[0], players[1], battleRules, turnLimit);
+
+	GameOutcome outcome;
+	bool gameOver = false;
+	while (!gameOver) {
+		int seat = turn % 2;
+		if (listener) listener->onTurnStart(board, players[seat]);
+
+		Action played = doTurn(seat);
+
+		//Line counters are kept up to date by the move itself, no rescan needed
+		char w = winnerAfter(board, played);
+		if (w != ' ') {
+			outcome.winnerSeat = (w == players[0].mark) ? 0 : 1;
+			outcome.winnerMark = w;
+			gameOver = true;
+		}
+		else if (board.isDraw()) {
+			gameOver = true;
+		}
+		else if (turnLimit > 0 && turn + 1 >= turnLimit) {
+			outcome.turnLimitHit = true;
+			gameOver = true;
+		}
+		else {
+			++turn;
+		}
+	}
+
+	outcome.turns = turn + 1;
+	if (replay) {
+		if (replayStandalone) replay->endGame(outcome.winnerSeat, outcome.turns);
+		else replay->roundEnd(outcome.winnerSeat, outcome.turns);
+	}
+	if (listener) listener->onGameOver(board, outcome);
+	return outcome;
+}
+
+Action TicTacToeGame::doTurn(int seat) {
+	Player& player = players[seat];
+	Archetype arch = battleRules ? player.archetype : Archetype::None;
+	Observation obs{ board, player, players[seat ^ 1], seat, turn, battleRules };
+
+	for (int attempt = 0; attempt < maxRejects; ++attempt) {
+		Action action = controllers[seat]->chooseAction(obs);
+		ActionError error;
+		{
+			TTT_PROFILE_SCOPE(RuleEval);
+			error = validateAction(board, action, arch);
+			if (error == ActionError::None) applyAction(board, action, player.mark);
+		}
+		if (error == ActionError::None) {
+			if (replay) replay->action(seat, action);
+			if (listener) listener->onAction(board, player, seat, action);
+			return action;
+		}
+		controllers[seat]->onRejected(obs, action, error);
+	}
+
+	//Controller keeps misbehaving, play the first legal action so the match can't stall
+	ActionList legal;
+	generateActions(Position::fromBoard(board, players[0].mark, players[1].mark, seat), arch, legal);
+	applyAction(board, legal.moves[0], player.mark);
+	if (replay) replay->action(seat, legal.moves[0]);
+	if (listener) listener->onAction(board, player, seat, legal.moves[0]);
+	return legal.moves[0];
+}
+
+
+// ------------- Campaign Tic Tac Toe -------------
+
+CampaignResult CampaignGame::run() {
+	out << "\n -- Campaign Tic Tac Toe Setup --\n";
+
+	if (replay) replay->beginCampaign(rng, roundLimit);
+	bool loaded = loadGame();
+
+	if (loaded) {
+		out << "A previous campaign was found.\n";
+		out << "Hero: " << hero.name
+			<< " (HP " << hero.hp << "/" << hero.maxHP
+			<< ", ATK " << hero.attack
+			<< ", DEF " << hero.defense << ")\n";
+		out << "You are currently at stage " << stage << ".\n";
+
+		bool resume = controller.continueSavedCampaign(hero, stage);
+		if (replay) replay->decision(ReplayDecision::ContinueSaved, resume);
+		if (!resume) {
+			setupHero();
+			stage = 0;
+		}
+		else {
+			out << "Resuming your adventure...\n\n";
+		}
+	}
+	else {
+		setupHero();
+		stage = 0;
+	}
+
+	enemyStrategy = controller.chooseEnemyStrategy();
+	if (replay) replay->decision(ReplayDecision::EnemyStrategy, static_cast<int>(enemyStrategy));
+
+	summary = CampaignSummary();
+	summary.hpOnEntry.fill(-1);
+
+	bool playing = true;
+	while (playing) {
+		TTT_PROFILE_SCOPE(CampaignStage);
+		if (0 <= stage && stage < static_cast<int>(summary.hpOnEntry.size())) {
+			summary.hpOnEntry[stage] = hero.hp;
+		}
+
+		switch (stage) {
+			case 0: {
+				introStory();
+				stage = 1;
+				break;
+			}
+			case 1:
+			case 3:
+			case 5:
+			case 7:
+			case 8:{
+				CampaignResult result = runBattle(stage);
+
+				if (result != CampaignResult::Victory) {
+					finishSummary(result);
+				}
+
+				if (result == CampaignResult::Defeat) {
+					if (saveStore) saveStore->remove(hero.name);	//A fallen hero leaves no slot behind
+					hero = Player();
+					legendWandered = 0;
+					legendWilderness = 0;
+					stage = 0;
+					
+					saveGame();
+					return CampaignResult::Defeat;
+				}
+				if (result == CampaignResult::Quit) {
+					saveGame();
+					return CampaignResult::Quit;
+				}
+
+				stage++;
+				saveGame();
+				break;
+			}
+			case 2:
+			case 4:
+			case 6:{
+				runEvent();
+				stage++;
+				saveGame();
+				break;
+			}
+			case 9: {
+				runEnding();
+				playing = false;
+				break;
+			}
+		}
+	}
+
+	finishSummary(CampaignResult::Victory);
+	return CampaignResult::Victory;
+}
+
+void CampaignGame::finishSummary(CampaignResult result) {
+	summary.result = result;
+	summary.endStage = stage;
+	summary.heroHP = hero.hp;
+	summary.heroMaxHP = hero.maxHP;
+	if (replay) replay->endGame(static_cast<int>(result), stage);
+}
+
+
+// -- Hero Creator --
+void CampaignGame::setupHero() {
+	out << "\n--- Create Your Hero ---\n";
+
+	hero = Player();
+	controller.createHero(hero.name, hero.archetype);
+	if (replay) replay->decision(ReplayDecision::CreateHero, static_cast<int>(hero.archetype), hero.name);
+
+	if (hero.name.empty()) {
+		hero.name = "Hero";
+	}
+
+	if (hero.archetype == Archetype::Paladin) {
+		hero.archetype = Archetype::Paladin;
+		hero.maxHP = 60;
+		hero.attack = 8;
+		hero.defense = 6;
+
+	}
+	else {
+		hero.archetype = Archetype::Alchemist;
+		hero.maxHP = 45;
+		hero.attack = 11;
+		hero.defense = 3;
+	}
+
+	hero.hp = hero.maxHP;
+	hero.mark = 'X';
+
+	out << "\nCreated " << hero.name << " the " << (hero.archetype == Archetype::Paladin ? "paladin" : "alchemist") << "!\n";
+	out << "HP " << hero.hp << "/" << hero.maxHP << ", ATK " << hero.attack << ", DEF " << hero.defense << "\n\n";
+
+}
+
+
+// -- Story --
+void CampaignGame::introStory() {
+	out << "...The Story Begins with an Evil Necromancer Halut attacking the Kingdom of Oplana...\n";
+	out << "You the Hero: " << hero.name << " has been entrusted by the king of Oplana to stop the evil necromancer and his minions.\n";
+}
+
+void CampaignGame::runEnding() {
+	out << "Hurrah! The Necromancer Halut had been defeated "
+		<< "thanks to you " << hero.name << " Oplana has been saved!\n";
+
+	if (legendWilderness > legendWandered) {
+		out << hero.name << " became a legend of the wilds.\n";
+	}
+	else if (legendWandered > legendWilderness) {
+		out << hero.name << " became a protector of people and of the roads.\n";
+	}
+	else {
+		out << hero.name << " walks the line between legend and mystery.\n";
+	}
+
+	out << "Your Legend:\n";
+	out << "Wandered Path Chosen: " << legendWandered << " times\n";
+	out << "Wilderness Path Chosen: " << legendWilderness << " times\n";
+}
+
+
+// -- Events --
+void CampaignGame::runEvent() {
+	randomEvent();
+
+	out << "\nCurrent Stats: HP " << hero.hp << "/" << hero.maxHP
+		<< ", ATK " << hero.attack << ", DEF " << hero.defense << "\n\n";
+}
+
+
+// -- Battles --
+
+CampaignResult CampaignGame::runBattle(int stage) {
+	bool isQuit = false;
+	if (stage == 3 || stage == 5 || stage == 7 || stage == 9) {
+		isQuit = controller.quitBeforeBattle(stage);
+		if (replay) replay->decision(ReplayDecision::QuitBeforeBattle, isQuit);
+	}
+	if (isQuit) {
+		out << "Saving and returning to menu...\n";
+		saveGame();
+		return CampaignResult::Quit;
+	}
+
+	out << "\n--- Battle Start! ---\n";
+
+	Enemy enemy = createEnemyForStage(stage);
+
+	out << hero.name << " encounters " << enemy.stats.name << "!\n";
+	out << "Your HP: " << hero.hp << "/" << hero.maxHP << " | Enemy HP: " << enemy.stats.hp << "/" << enemy.stats.maxHP << "\n";
+
+	//Abilites state
+	bool usedBrittleBones = false;
+	bool usedCorporeal = false;
+	int thickSkinHitsLeft = 0;
+	int heroCurseRounds = 0;
+	bool bossBuffApplied = false;
+
+	handleEnemyAbilities(enemy, hero, roundOutcome::Tie, usedBrittleBones, usedCorporeal, thickSkinHitsLeft,
+		heroCurseRounds, bossBuffApplied);
+
+	//Play until either Hero or Enemy dies
+	int rounds = 0;
+	while (hero.hp > 0 && enemy.stats.hp > 0) {
+		if (roundLimit > 0 && rounds++ >= roundLimit) {
+			out << "Neither side can break through. " << hero.name << " withdraws from the battle.\n";
+			summary.stalemate = true;
+			return CampaignResult::Quit;
+		}
+		summary.roundsPlayed++;
+
+		out << "\nA new round of Tic-Tac-Toe begins!\n";
+
+		roundOutcome result = playOneBoard(hero, enemy);
+
+		if (result == roundOutcome::HeroWin) {
+			int effectiveHeroAtk = hero.attack;
+			if (heroCurseRounds > 0) {
+				effectiveHeroAtk = hero.attack - 3;
+				if (effectiveHeroAtk < 0) effectiveHeroAtk = 0;
+				out << "The curse weakens your attack this round (-3 ATK).\n";
+			}
+
+			int damage = calculateDamage(effectiveHeroAtk, enemy.stats.defense);
+
+			if (thickSkinHitsLeft > 0) {
+				int reduced = damage - 3;
+				if (reduced < 1) reduced = 1;
+				out << enemy.stats.name << "'s thick skin reduces the blow! (-3 damage)\n";
+				damage = reduced;
+				thickSkinHitsLeft = 0; // used up
+			}
+
+			applyDamage(enemy.stats, damage);
+			printDamage(hero.name, enemy.stats.name, damage,
+				enemy.stats.hp, enemy.stats.maxHP);
+		}
+		else if (result == roundOutcome::EnemyWin) {
+			// --- Enemy damage (normal) ---
+			int damage = calculateDamage(enemy.stats.attack, hero.defense);
+			applyDamage(hero, damage);
+			printDamage(enemy.stats.name, hero.name, damage,
+				hero.hp, hero.maxHP);
+		}
+		else {
+			out << "No Damage was dealt this round.\n";
+		}
+
+		handleEnemyAbilities(
+			enemy,
+			hero,
+			result,
+			usedBrittleBones,
+			usedCorporeal,
+			thickSkinHitsLeft,
+			heroCurseRounds,
+			bossBuffApplied
+		);
+
+		// Tick down hero curse duration at end of round
+		if (heroCurseRounds > 0) {
+			heroCurseRounds--;
+			if (heroCurseRounds == 0) {
+				out << "The dark curse fades. Your strength returns.\n";
+			}
+		}
+
+		out << "\nStatus: HP: " << hero.hp << "/" << hero.maxHP << " | Enemy HP: " << enemy.stats.hp << "/" << enemy.stats.maxHP << "\n\n";
+	}
+
+	if (hero.hp <= 0) {
+		out << "\n" << hero.name << " has fallen in battle...\n";
+		out << "The Campaign has Ended...\n";
+		out << "Returning to the Main Menu\n";
+
+		return CampaignResult::Defeat;
+	}
+	else if (enemy.stats.hp <= 0) {
+		out << "\n" << enemy.stats.name << " is defeated!\n";
+	}
+
+	return CampaignResult::Victory;
+}
+
+
+// -- Enemy Abilities --
+
+void CampaignGame::handleEnemyAbilities(Enemy& enemy, Player& hero, roundOutcome result, bool& usedBrittleBones, bool& usedCorporeal,
+						int& thickSkinHitsLeft, int& heroCurseRounds, bool& bossBuffApplied) {
+	TTT_PROFILE_SCOPE(EnemyAbilities);
+
+	// --- Boss opening ritual (BossBuff) applied once at start ---
+	if (!bossBuffApplied && enemy.a1 == EnemyAbility::Opening) {
+		out << "Halut begins the battle with a dark ritual, empowering himself!\n";
+		enemy.stats.maxHP += 10;
+		enemy.stats.hp += 10;
+		if (enemy.stats.hp > enemy.stats.maxHP) enemy.stats.hp = enemy.stats.maxHP;
+		enemy.stats.attack += 2;
+		out << enemy.stats.name << " gains +10 HP and +2 ATK!\n";
+		bossBuffApplied = true;
+	}
+
+	// --- Skeleton: Brittle Bones (one-time) ---
+	if (enemy.a1 == EnemyAbility::BrittleBones &&
+		!usedBrittleBones &&
+		result == roundOutcome::HeroWin &&
+		enemy.stats.hp > 0 && hero.hp > 0) {
+
+		out << enemy.stats.name << "'s brittle bones crack, it's broken bones hurt\n";
+		enemy.stats.attack += 3;
+		enemy.stats.hp -= 5;
+		if (enemy.stats.hp < 1) enemy.stats.hp = 1;
+		out << enemy.stats.name << " gains +3 ATK but loses 5 HP. "
+			<< "ATK: " << enemy.stats.attack
+			<< ", HP: " << enemy.stats.hp << "/" << enemy.stats.maxHP << "\n";
+
+		usedBrittleBones = true;
+	}
+
+	// --- Zombie: Thick Skin (next hit -3 damage) ---
+	if (enemy.a1 == EnemyAbility::ThickSkin &&
+		thickSkinHitsLeft == 0 &&
+		result == roundOutcome::HeroWin &&
+		enemy.stats.hp > 0 && hero.hp > 0) {
+
+		int chance = randomInt(rng, 0, 99);
+		if (chance < 40) {
+			out << enemy.stats.name << "'s skin hardens, reducing the next blow!\n";
+			thickSkinHitsLeft = 1;
+		}
+	}
+
+	// --- Ghost: Corporeal (one-time HP+5, maxHP+5, -3 ATK) ---
+	if (enemy.a1 == EnemyAbility::Corporeal &&
+		!usedCorporeal &&
+		enemy.stats.hp > 0 &&
+		enemy.stats.hp <= enemy.stats.maxHP / 2) {
+
+		out << enemy.stats.name << " begins to take on a more solid form...\n";
+		enemy.stats.maxHP += 5;
+		enemy.stats.hp += 5;
+		if (enemy.stats.hp > enemy.stats.maxHP) enemy.stats.hp = enemy.stats.maxHP;
+		enemy.stats.attack -= 3;
+		if (enemy.stats.attack < 0) enemy.stats.attack = 0;
+
+		out << enemy.stats.name << " becomes corporeal! +5 max HP, +5 HP, -3 ATK.\n";
+		out << "HP: " << enemy.stats.hp << "/" << enemy.stats.maxHP
+			<< ", ATK: " << enemy.stats.attack << "\n";
+
+		usedCorporeal = true;
+	}
+
+	// --- Boss second ability: BossCurse (-3 ATK for hero for 2 rounds) ---
+	if (enemy.a2 == EnemyAbility::CurseWeakness &&
+		result == roundOutcome::EnemyWin &&
+		hero.hp > 0 &&
+		heroCurseRounds == 0) {
+
+		int chance = randomInt(rng, 0, 99);
+		if (chance < 50) {
+			out << enemy.stats.name << " utters a dark curse! Your strength falters!\n";
+			heroCurseRounds = 2;
+		}
+	}
+}
+
+
+// -- Enemys Possible --
+
+Enemy CampaignGame::createEnemyForStage(int stage) {
+	Enemy e;
+	e.strategy = enemyStrategy;
+
+	//Tiered picks per enemy once its signature ability is known
+	auto applyTier = [&]() {
+		if (enemyStrategy != EnemyStrategy::Tiered) return;
+		EnemyTier tier = enemyTierFor(e.a1, stage, bossSearchDepth);
+		e.strategy = tier.strategy;
+		e.searchDepth = tier.searchDepth;
+	};
+
+	if (stage == 8) {
+		e.stats.name = "Necromancer Halut";
+		e.stats.mark = 'O';
+		e.stats.maxHP = 55;
+		e.stats.hp = 55;
+		e.stats.attack = 12;
+		e.stats.defense = 4;
+
+		//Special Abilities
+		e.a1 = EnemyAbility::Opening;
+		e.a2 = EnemyAbility::CurseWeakness;
+
+		applyTier();
+		return e;
+	}
+
+	int roll;
+	do {
+		roll = randomInt(rng, 0, 2); //0 - Skeleton, 1 - Zombie, 2 - Ghost
+	} while (roll == lastEnemyType && lastEnemyType != -1);
+
+	lastEnemyType = roll;
+
+	switch (roll) {
+	case 0: {
+		e.stats.name = "Skeleton";
+		e.stats.mark = 'O';
+		e.stats.maxHP = 30;
+		e.stats.hp = 30;
+		e.stats.attack = 7;
+		e.stats.defense = 2;
+		e.a1 = EnemyAbility::BrittleBones;
+		break;
+	}
+	case 1: {
+		e.stats.name = "Zombie";
+		e.stats.mark = 'O';
+		e.stats.maxHP = 28;
+		e.stats.hp = 28;
+		e.stats.attack = 8;
+		e.stats.defense = 3;
+		e.a1 = EnemyAbility::ThickSkin;
+		break;
+	}
+	case 2:
+	default: {
+		e.stats.name = "Ghost";
+		e.stats.mark = 'O';
+		e.stats.maxHP = 12;
+		e.stats.hp = 12;
+		e.stats.attack = 11;
+		e.stats.defense = 1;
+		e.a1 = EnemyAbility::Corporeal;
+		break;
+	}
+	}
+	
+	int hpBonus = max(0, stage - 1) * 2;
+	int atkBonus = max(0, stage - 1) / 2;
+
+	e.stats.maxHP += hpBonus;
+	e.stats.hp += hpBonus;
+	e.stats.attack += atkBonus;
+
+	applyTier();
+	return e;
+}
+
+
+// -- Event Gen --
+
+void CampaignGame::randomEvent() {
+	CampaignPath path = controller.choosePath();
+	if (replay) replay->decision(ReplayDecision::Path, static_cast<int>(path));
+	if (path == CampaignPath::Wandered) {
+		legendWandered++;
+		randomEventWandered();
+	}
+	else {
+		legendWilderness++;
+		randomEventWilderness();
+	}
+}
+
+void CampaignGame::randomEventWandered() {
+	out << "\n --- A Random Wandered Event Occurs! ---\n";
+	int roll = randomInt(rng, 0, 3);
+
+	switch (roll) {
+	case 0:
+		eventHealingFountain();
+		break;
+	case 1:
+		eventTrainingGrounds();
+		break;
+	case 2:
+		eventChurch();
+		break;
+	case 3:
+		eventNothing();
+		break;
+	}
+}
+
+void CampaignGame::randomEventWilderness() {
+	out << "\n --- A Random Wilderness Event Occurs! ---\n";
+	int roll = randomInt(rng, 0, 4);
+
+	switch (roll) {
+	case 0:
+		eventShimmeringLake();
+		break;
+	case 1:
+		eventWildTraining();
+		break;
+	case 2:
+		eventMysteriousShrine();
+		break;
+	case 3:
+		eventNothing();
+		break;
+	case 4:
+		eventAnimalAtk();
+		break;
+	}
+}
+
+
+// -- Events Possible --
+
+void CampaignGame::eventTrainingGrounds() {
+	out << hero.name << " visits a quiet training yard.\n";
+	hero.attack += 1;
+	out << "Attack increases by 1. ATK is now " << hero.attack << ".\n";
+}
+
+void CampaignGame::eventChurch() {
+	out << hero.name << " finds a small church where a priest offers a blessing.\n";
+	int heal = randomInt(rng, 5, 10);
+	int oldHP = hero.hp;
+	hero.hp += heal;
+	if (hero.hp > hero.maxHP) hero.hp = hero.maxHP;
+	out << "You recover " << (hero.hp - oldHP) << " HP.\n";
+}
+
+void CampaignGame::eventNothing() {
+	out << hero.name << " wanders for a while, but nothing remarkable happens.\n";
+}
+
+void CampaignGame::eventShimmeringLake() {
+	out << hero.name << " discovers a shimmering lake in the wilderness.\n";
+	out << "(You can make this a stronger heal or buff later.)\n";
+}
+
+void CampaignGame::eventWildTraining() {
+	out << hero.name << " trains alone in the wild, pushing body and mind.\n";
+	hero.attack += 1;
+	hero.defense += 1;
+	out << "ATK +1, DEF +1. ATK: " << hero.attack << ", DEF: " << hero.defense << "\n";
+}
+
+void CampaignGame::eventAnimalAtk() {
+	out << hero.name << " is ambushed by wild beasts!\n";
+	int dmg = randomInt(rng, 3, 8);
+	hero.hp -= dmg;
+	if (hero.hp < 0) hero.hp = 0;
+	out << "You take " << dmg << " damage. HP: " << hero.hp << "/" << hero.maxHP << "\n";
+}
+
+void CampaignGame::eventHealingFountain() {
+	out << "\n" << hero.name << " discovers a glowing healing fountain.\n";
+	out << "Clear water pulses with magical warmth...\n";
+
+	if (hero.hp == hero.maxHP) {
+		out << "You already feel fully restored. The water has no effect.\n";
+		return;
+	}
+
+	hero.hp = hero.maxHP;
+	out << "You drink from the fountain and are fully healed!\n";
+	out << "HP restored to " << hero.hp << "/" << hero.maxHP << ".\n";
+}
+
+void CampaignGame::eventMysteriousShrine() {
+	out << "\n" << hero.name << " approaches a dark shrine glowing with eerie light...\n";
+	out << "An ancient voice whispers: \"Power... for a price.\" \n";
+
+	bool touched = controller.touchShrine();
+	if (replay) replay->decision(ReplayDecision::Shrine, touched);
+	if (!touched) {
+		out << "You step away, unwilling to risk your fate.\n";
+		return;
+	}
+
+	out << "A surge of energy flows through the altar...\n";
+
+	int outcome = randomInt(rng, 0, 1); // 0 = Blessing, 1 = Curse
+
+	if (outcome == 0) {
+		out << "A HOLY LIGHT bursts forth!\n";
+		out << "The shrine grants you a Holy Sword!\n";
+		out << "Attack increases by 5!\n";
+
+		hero.attack += 5;
+		out << "ATK is now " << hero.attack << ".\n";
+	}
+	else {
+		out << "A DARK CURSE grips your soul...\n";
+		out << "Your life force is drained!\n";
+
+		hero.maxHP -= 10;
+		if (hero.maxHP < 1) hero.maxHP = 1;
+
+		if (hero.hp > hero.maxHP) hero.hp = hero.maxHP;
+
+		out << "Max HP is reduced by 10! (Now " << hero.maxHP << ")\n";
+		out << "Current HP: " << hero.hp << "/" << hero.maxHP << "\n";
+	}
+}
+
+
+// -- Stat Calculations & Game --
+
+int CampaignGame::calculateDamage(int attack, int defense) {
+	int raw = attack - defense;
+	if (raw < 1) {
+		raw = 1; //Minimum Damage
+	}
+	return raw;
+}
+
+void CampaignGame::applyDamage(Player& target, int damage) {
+	target.hp -= damage;
+	if (target.hp < 0) {
+		target.hp = 0;
+	}
+}
+
+void CampaignGame::printDamage(const string& attackerName, const string& defenderName, int damage, int defenderHP, int defenderMAXHP) {
+	out << attackerName << " deals " << damage << " damage to " << defenderName << "! (HP: " << defenderHP << "/" << defenderMAXHP << ")\n";
+}
+
+
+// -- Round Outcome --
+
+roundOutcome CampaignGame::playOneBoard(Player& heroPlayer, const Enemy& enemy) {
+	StrategyController enemyController(enemy.strategy);
+	enemyController.rng = &rng;
+	enemyController.searchDepth = enemy.searchDepth;
+
+	TicTacToeGame round;
+	round.setPlayer(0, heroPlayer, controller.heroController());
+	round.setPlayer(1, enemy.stats, enemyController);
+	round.setListener(controller.roundListener());
+	round.setReplay(replay, false);
+
+	GameOutcome outcome = round.run();
+	if (outcome.winnerSeat == -1) {
+		out << "This round ends in a Tie!\n";
+		return roundOutcome::Tie;
+	}
+
+	out << outcome.winnerMark << " won the battle!\n";
+	return (outcome.winnerSeat == 0) ? roundOutcome::HeroWin : roundOutcome::EnemyWin;
+}
+
+
+// -- Saving / Loading --
+
+void CampaignGame::saveGame() {
+	TTT_PROFILE_SCOPE(SaveWrite);
+	CampaignSaveData data;
+	data.hero = hero;
+	data.stage = stage;
+	data.legendWandered = legendWandered;
+	data.legendWilderness = legendWilderness;
+	data.hasRng = true;
+	data.rng = rng;
+	data.lastEnemyType = lastEnemyType;
+
+	if (saveStore) {
+		if (hero.name.empty()) return;	//Slots are keyed by name
+		if (!saveStore->store(data)) out << "(Warning: could not write the save slot.)\n";
+		return;
+	}
+
+	if (savePath.empty()) return;
+	if (!writeCampaignSave(savePath, data)) {
+		out << "(Warning: could not write the save file.)\n";
+	}
+}
+
+bool CampaignGame::loadGame() {
+	TTT_PROFILE_SCOPE(SaveLoad);
+	CampaignSaveData data;
+	SaveStatus status = SaveStatus::Missing;
+
+	if (resumeFrom) {
+		data = *resumeFrom;
+		status = SaveStatus::Ok;
+	}
+	else if (saveStore) {
+		if (!saveSlot.empty()) status = saveStore->load(saveSlot, data);
+	}
+	else if (!savePath.empty()) {
+		status = readCampaignSave(savePath, data);
+	}
+
+	if (status == SaveStatus::Missing && !resumeFrom && !saveStore && !savePath.empty() && !legacySavePath.empty()) {
+		status = readLegacyTextSave(legacySavePath, data);
+	}
+
+	switch (status) {
+	case SaveStatus::Ok:
+		break;
+	case SaveStatus::Migrated:
+		out << "(Converted an old text save; it will be saved in the new format.)\n";
+		break;
+	case SaveStatus::Corrupt:
+		out << "(Warning: the save file is damaged and was ignored.)\n";
+		return false;
+	case SaveStatus::NewerVersion:
+		out << "(Warning: the save file is from a newer version and was ignored.)\n";
+		return false;
+	case SaveStatus::Missing:
+	default:
+		return false;  // no save file
+	}
+
+	hero = data.hero;
+	stage = data.stage;
+	legendWandered = data.legendWandered;
+	legendWilderness = data.legendWilderness;
+	lastEnemyType = data.lastEnemyType;
+	if (data.hasRng) rng = data.rng;	//Resume the same random sequence
+	if (replay) replay->loadedSave(data);
+	return true;
+}
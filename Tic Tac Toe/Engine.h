@@ -0,0 +1,357 @@
+#pragma once
+
+#include "Rules.h"
+#include "BattleSearch.h"
+#include "Rng.h"
+
+#include <string>
+#include <ostream>
+
+
+// ------------- Player -------------
+
+struct Player {
+	std::string name;
+	char mark = 'X';
+	Archetype archetype = Archetype::None;
+
+	// -- Stats --
+	int maxHP = 0;
+	int hp = 0;
+	int attack = 0;
+	int defense = 0;
+};
+
+
+// -- Campaign Outcome --
+
+enum class CampaignResult {
+	Victory, Defeat, Quit
+};
+
+enum class roundOutcome {
+	HeroWin, EnemyWin, Tie
+};
+
+
+// ------------- Enemy -------------
+
+enum class EnemyAbility {
+	//Abilits to be added
+	None,
+	BrittleBones,	//Skeleton
+	ThickSkin,		//Zombie
+	Corporeal,		//Ghost
+	Opening,		//Boss 1
+	CurseWeakness	//Boss 2
+};
+
+enum class EnemyStrategy {
+	Random,		//Any empty cell
+	Perfect,	//Solver table lookup
+	Greedy,		//Win or block when it can, otherwise random
+	Search,		//Depth-limited alpha-beta
+	Tiered,		//Campaign only: each enemy type gets its own strategy (enemyTierFor)
+	Mcts		//Monte Carlo tree search, a fixed number of iterations
+};
+
+struct Enemy {
+	Player stats;
+	EnemyAbility a1 = EnemyAbility::None;
+	EnemyAbility a2 = EnemyAbility::None; //a2 for Boss Only!
+
+	// -- How it plays its cells --
+	EnemyStrategy strategy = EnemyStrategy::Random;
+	int searchDepth = 9;	//Search only
+};
+
+// -- Tiered Difficulty --
+
+struct EnemyTier {
+	EnemyStrategy strategy;
+	int searchDepth;
+};
+
+//Strategy for an enemy, by its signature ability (a1) and the stage it guards
+EnemyTier enemyTierFor(EnemyAbility signature, int stage, int bossDepth);
+
+//Per-thread engine seeded from random_device, for callers that don't need reproducibility
+Rng& globalRng();
+
+int randomEmptyCell(const Board& board, Rng& gen);
+int randomEmptyCell(const Board& board);
+int randomInt(Rng& gen, int min, int max);
+int randomInt(int min, int max);
+//Search runs to searchDepth with no clock; Tiered plays as Random here
+int chooseEnemyCell(const Board& board, EnemyStrategy strategy, char enemyMark, char heroMark, Rng& gen, int searchDepth = 9);
+
+
+// ------------- Controllers -------------
+
+// Everything a controller gets to see when it is asked for an action
+struct Observation {
+	const Board& board;
+	const Player& self;
+	const Player& opponent;
+	int seat;			//0 moves first
+	int turn;
+	bool battleRules;	//Swap/Shift allowed for the matching archetype
+};
+
+// Decides the actions for one seat. The console, scripted bots and the AIs
+// are all controllers; the engine never reads input itself.
+class PlayerController {
+public:
+	virtual ~PlayerController() = default;
+
+	virtual Action chooseAction(const Observation& obs) = 0;
+
+	//The engine refused the last action, chooseAction is called again
+	virtual void onRejected(const Observation&, const Action&, ActionError) {}
+};
+
+// Places wherever the enemy strategy points
+class StrategyController : public PlayerController {
+public:
+	explicit StrategyController(EnemyStrategy strategy = EnemyStrategy::Random) : strategy(strategy) {}
+
+	EnemyStrategy strategy;
+	Rng* rng = nullptr;	//nullptr uses globalRng()
+	int searchDepth = 9;
+
+	Action chooseAction(const Observation& obs) override;
+};
+
+// Uniform over every legal action, swaps and shifts included
+class RandomController : public PlayerController {
+public:
+	Rng* rng = nullptr;	//nullptr uses globalRng()
+
+	Action chooseAction(const Observation& obs) override;
+};
+
+// Alpha-beta Battle search, also plays plain games (archetype None only places)
+class BattleAIController : public PlayerController {
+public:
+	explicit BattleAIController(int depth = 9) : depth(depth) {}
+
+	Action chooseAction(const Observation& obs) override;
+
+private:
+	BattleSearch search;
+	int depth;
+	bool ready = false;
+	Archetype archetypes[2] = { Archetype::None, Archetype::None };
+};
+
+
+// ------------- Match Events -------------
+
+struct GameOutcome {
+	int winnerSeat = -1;	//-1 for a Tie
+	char winnerMark = ' ';
+	int turns = 0;
+	bool turnLimitHit = false;	//Counted as a Tie
+};
+
+// Optional hooks for whoever wants to show the match (console, logs...)
+class MatchListener {
+public:
+	virtual ~MatchListener() = default;
+
+	virtual void onTurnStart(const Board&, const Player&) {}
+	virtual void onAction(const Board&, const Player&, int /*seat*/, const Action&) {}
+	virtual void onGameOver(const Board&, const GameOutcome&) {}
+};
+
+
+// ------------- Base Game Class -------------
+
+class ReplayWriter;
+
+// Headless turn loop shared by every mode. Derived front ends fill in the
+// players and controllers in setupPlayers(); headless callers use setPlayer().
+class TicTacToeGame {
+public:
+	virtual ~TicTacToeGame() = default;
+
+	GameOutcome run();
+
+	void setPlayer(int seat, const Player& player, PlayerController& controller) {
+		players[seat] = player;
+		controllers[seat] = &controller;
+	}
+
+	void setListener(MatchListener* l) { listener = l; }
+	void setBattleRules(bool on) { battleRules = on; }
+
+	//Battle swaps and shifts can cycle forever; 0 = no limit
+	void setTurnLimit(int limit) { turnLimit = limit; }
+
+	//Logs the whole match; a campaign round (standalone = false) logs only its actions and result
+	void setReplay(ReplayWriter* writer, bool standalone = true) {
+		replay = writer;
+		replayStandalone = standalone;
+	}
+
+	const Board& getBoard() const { return board; }
+	const Player& getPlayer(int seat) const { return players[seat]; }
+
+	//Consecutive refused actions before the engine plays the first legal one itself
+	static constexpr int maxRejects = 16;
+
+protected:
+	Board board;
+	Player players[2];
+	PlayerController* controllers[2] = { nullptr, nullptr };
+	MatchListener* listener = nullptr;
+	bool battleRules = false;
+	int turnLimit = 0;
+	int turn{ 0 };
+	ReplayWriter* replay = nullptr;
+	bool replayStandalone = true;
+
+	virtual void setupPlayers() {}
+	Action doTurn(int seat);	//Returns the action played
+};
+
+
+// ------------- Campaign Tic Tac Toe -------------
+
+class SaveStore;
+struct CampaignSaveData;
+
+enum class CampaignPath {
+	Wandered,	//Less Dangerous, Less Rewards
+	Wilderness	//More Dangerous, More Rewards
+};
+
+// Every decision the campaign needs from outside the engine
+class CampaignController {
+public:
+	virtual ~CampaignController() = default;
+
+	virtual bool continueSavedCampaign(const Player& hero, int stage) = 0;
+	virtual void createHero(std::string& name, Archetype& archetype) = 0;
+	virtual EnemyStrategy chooseEnemyStrategy() = 0;
+	virtual bool quitBeforeBattle(int stage) = 0;
+	virtual CampaignPath choosePath() = 0;
+	virtual bool touchShrine() = 0;
+
+	//Plays the hero's cells in each round
+	virtual PlayerController& heroController() = 0;
+	virtual MatchListener* roundListener() { return nullptr; }
+};
+
+// Stream that swallows everything, for campaigns nobody is watching
+class NullStream : public std::ostream {
+public:
+	NullStream() : std::ostream(nullptr) {}
+};
+
+// What happened during the last run(), for simulations and reports
+struct CampaignSummary {
+	CampaignResult result = CampaignResult::Quit;
+	int endStage = 0;						//Stage the campaign ended on
+	int heroHP = 0;							//Taken before a defeat resets the hero
+	int heroMaxHP = 0;
+	int roundsPlayed = 0;
+	bool stalemate = false;					//Gave up after roundLimit rounds
+	std::array<int, 10> hpOnEntry{};		//Hero HP as each stage began, -1 if never reached
+};
+
+class CampaignGame {
+public:
+	CampaignGame(CampaignController& controller, std::ostream& out) : controller(controller), out(out) {}
+
+	CampaignResult run();
+
+	//Same engine state + same controller decisions = same campaign
+	void setRng(const Rng& r) { rng = r; }
+	const Rng& getRng() const { return rng; }
+
+	//Empty disables saving and loading
+	std::string savePath = "campaign_save.dat";
+
+	//Text save from older builds, read once when savePath doesn't exist yet
+	std::string legacySavePath = "campaign_save.txt";
+
+	//When set, saves go here under the hero's name instead of savePath,
+	//and the campaign resumes the hero named saveSlot (if any)
+	SaveStore* saveStore = nullptr;
+	std::string saveSlot;
+
+	//Loaded instead of any save file, so a replay starts from the recorded save
+	const CampaignSaveData* resumeFrom = nullptr;
+
+	//Logs the starting Rng, loaded save, every controller decision and every round
+	ReplayWriter* replay = nullptr;
+
+	//Rounds a single battle may last before the hero withdraws (Quit), 0 = no limit
+	int roundLimit = 0;
+
+	//Tiered difficulty: how deep Halut searches. Enemies stop on depth or iterations, never the clock,
+	//so a replay or a simulation plays the same moves as the live game
+	int bossSearchDepth = 9;
+
+	const Player& getHero() const { return hero; }
+	int getStage() const { return stage; }
+	const CampaignSummary& getSummary() const { return summary; }
+
+private:
+	CampaignController& controller;
+	std::ostream& out;	//Story and battle narration
+	Rng rng{ globalRng()() };
+	CampaignSummary summary;
+
+	Player hero;	//The Player's Character
+	int stage = 0; //Campaign Progress Tracker
+
+	// -- Legend Tracking --
+	int legendWandered = 0;
+	int legendWilderness = 0;
+
+	// -- Tracking Enemy Type --
+	int lastEnemyType = -1;
+
+	// -- Enemy Difficulty --
+	EnemyStrategy enemyStrategy = EnemyStrategy::Random;
+
+	void setupHero();
+	void finishSummary(CampaignResult result);
+
+	// -- Story --
+	void introStory();
+	void runEnding();
+
+	// -- Events --
+	void runEvent();
+	void randomEvent();
+	void randomEventWandered();
+	void randomEventWilderness();
+
+	void eventTrainingGrounds();
+	void eventChurch();
+	void eventNothing();
+	void eventShimmeringLake();
+	void eventWildTraining();
+	void eventAnimalAtk();
+	void eventHealingFountain();
+	void eventMysteriousShrine();
+
+	// -- Battles --
+	CampaignResult runBattle(int stage);
+	void handleEnemyAbilities(Enemy& enemy, Player& hero, roundOutcome result, bool& usedBrittleBones, bool& usedCorporeal,
+							int& thickSkinHitsLeft, int& heroCurseRounds, bool& bossBuffApplied);
+	Enemy createEnemyForStage(int stage);
+	roundOutcome playOneBoard(Player& heroPlayer, const Enemy& enemy);
+
+	// -- Stat Calculations --
+	int calculateDamage(int attack, int defense);
+	void applyDamage(Player& target, int damage);
+	void printDamage(const std::string& attackerName, const std::string& defenderName, int damage, int defenderHP, int defenderMAXHP);
+
+	// -- Saving / Loading --
+	void saveGame();
+	bool loadGame();
+};
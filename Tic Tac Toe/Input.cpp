@@ -0,0 +1,273 @@
+#include "Input.h"
+
+#include <algorithm>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+
+// ------------- Input Channel -------------
+
+void InputChannel::push(string line) {
+	{
+		lock_guard<mutex> lock(m);
+		lines.push_back(move(line));
+	}
+	arrived.notify_all();
+}
+
+void InputChannel::pushText(string_view text) {
+	{
+		lock_guard<mutex> lock(m);
+		while (!text.empty()) {
+			size_t end = text.find('\n');
+			string_view line = text.substr(0, end);
+			if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+			lines.emplace_back(line);
+			text.remove_prefix(end == string_view::npos ? text.size() : end + 1);
+		}
+	}
+	arrived.notify_all();
+}
+
+void InputChannel::close() {
+	{
+		lock_guard<mutex> lock(m);
+		closed = true;
+	}
+	arrived.notify_all();
+}
+
+InputStatus InputChannel::tryRead(string& line) {
+	lock_guard<mutex> lock(m);
+	if (!lines.empty()) {
+		line = move(lines.front());
+		lines.pop_front();
+		return InputStatus::Line;
+	}
+	return closed ? InputStatus::Closed : InputStatus::Timeout;
+}
+
+InputStatus InputChannel::read(string& line, int timeoutMs) {
+	if (timeoutMs <= 0) return readUntil(line, noDeadline);
+	return readUntil(line, chrono::steady_clock::now() + chrono::milliseconds(timeoutMs));
+}
+
+InputStatus InputChannel::readUntil(string& line, InputDeadline deadline) {
+	unique_lock<mutex> lock(m);
+	auto ready = [&]() { return !lines.empty() || closed; };
+	if (deadline == noDeadline) arrived.wait(lock, ready);
+	else if (!arrived.wait_until(lock, deadline, ready)) return InputStatus::Timeout;
+
+	if (lines.empty()) return InputStatus::Closed;
+	line = move(lines.front());
+	lines.pop_front();
+	return InputStatus::Line;
+}
+
+size_t InputChannel::pending() const {
+	lock_guard<mutex> lock(m);
+	return lines.size();
+}
+
+
+// ------------- Input Loop -------------
+
+InputLoop::InputLoop() {
+#if !defined(_WIN32)
+	if (pipe(wakePipe) == 0) {
+		for (int fd : wakePipe) fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+	}
+#endif
+}
+
+InputLoop::~InputLoop() {
+	stop();
+#if !defined(_WIN32)
+	for (int fd : wakePipe) {
+		if (fd >= 0) ::close(fd);
+	}
+#endif
+}
+
+void InputLoop::addFd(int fd, shared_ptr<InputChannel> channel) {
+#if defined(_WIN32)
+	//Console handles can't be polled; a reader thread per source blocks for the loop instead
+	thread([fd, channel]() {
+		string partial;
+		char buffer[4096];
+		int got;
+		while ((got = _read(fd, buffer, sizeof(buffer))) > 0) {
+			partial.append(buffer, static_cast<size_t>(got));
+			size_t start = 0, end;
+			while ((end = partial.find('\n', start)) != string::npos) {
+				size_t len = (end > start && partial[end - 1] == '\r') ? end - start - 1 : end - start;
+				channel->push(partial.substr(start, len));
+				start = end + 1;
+			}
+			partial.erase(0, start);
+		}
+		if (!partial.empty()) channel->push(partial);
+		channel->close();
+	}).detach();
+#else
+	{
+		lock_guard<mutex> lock(m);
+		Source source;
+		source.fd = fd;
+		source.channel = move(channel);
+		sources.push_back(move(source));
+	}
+	wake();
+#endif
+}
+
+void InputLoop::addScript(vector<string> lines, shared_ptr<InputChannel> channel, int intervalMs) {
+	Source source;
+	source.channel = move(channel);
+	source.interval = chrono::milliseconds(max(0, intervalMs));
+	source.due = chrono::steady_clock::now() + source.interval;
+	if (intervalMs <= 0) {
+		for (string& line : lines) source.channel->push(move(line));
+	}
+	else {
+		source.script.assign(make_move_iterator(lines.begin()), make_move_iterator(lines.end()));
+	}
+
+	{
+		lock_guard<mutex> lock(m);
+		sources.push_back(move(source));
+	}
+	wake();
+}
+
+void InputLoop::start() {
+	lock_guard<mutex> lock(m);
+	if (worker.joinable()) return;
+	stopping = false;
+	worker = thread([this]() { run(); });
+}
+
+void InputLoop::stop() {
+	{
+		lock_guard<mutex> lock(m);
+		stopping = true;
+	}
+	wake();
+	if (worker.joinable()) worker.join();
+}
+
+void InputLoop::wake() {
+	changed.notify_all();
+#if !defined(_WIN32)
+	if (wakePipe[1] >= 0) {
+		char byte = 1;
+		ssize_t ignored = ::write(wakePipe[1], &byte, 1);
+		(void)ignored;
+	}
+#endif
+}
+
+//Drops a finished source; its channel closes unless another source still feeds it
+void InputLoop::finish(size_t index) {
+	shared_ptr<InputChannel> channel = move(sources[index].channel);
+	sources.erase(sources.begin() + static_cast<ptrdiff_t>(index));
+	bool shared = any_of(sources.begin(), sources.end(), [&](const Source& s) { return s.channel == channel; });
+	if (!shared) channel->close();
+}
+
+//One read from a source poll() reported ready; false at end of input
+bool InputLoop::readSource(Source& source) {
+#if defined(_WIN32)
+	(void)source;
+	return false;
+#else
+	char buffer[4096];
+	ssize_t got = ::read(source.fd, buffer, sizeof(buffer));
+	if (got < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)) return true;
+	if (got <= 0) {
+		if (!source.partial.empty()) source.channel->push(move(source.partial));	//Last line without '\n'
+		source.partial.clear();
+		return false;
+	}
+
+	string& partial = source.partial;
+	partial.append(buffer, static_cast<size_t>(got));
+	size_t start = 0, end;
+	while ((end = partial.find('\n', start)) != string::npos) {
+		size_t len = (end > start && partial[end - 1] == '\r') ? end - start - 1 : end - start;
+		source.channel->push(partial.substr(start, len));
+		start = end + 1;
+	}
+	partial.erase(0, start);
+	return true;
+#endif
+}
+
+void InputLoop::run() {
+	using Clock = chrono::steady_clock;
+
+#if !defined(_WIN32)
+	vector<pollfd> polled;
+	vector<size_t> owners;	//Source index for each polled fd past the wake pipe
+#endif
+
+	while (true) {
+		unique_lock<mutex> lock(m);
+		if (stopping) return;
+
+		//Scripted lines that are due, and the wait until the next one
+		auto now = Clock::now();
+		auto next = Clock::time_point::max();
+		for (size_t i = sources.size(); i-- > 0;) {
+			Source& s = sources[i];
+			if (s.fd >= 0) continue;
+			while (!s.script.empty() && s.due <= now) {
+				s.channel->push(move(s.script.front()));
+				s.script.pop_front();
+				s.due += s.interval;
+			}
+			if (s.script.empty()) finish(i);
+			else next = min(next, s.due);
+		}
+		int timeoutMs = (next == Clock::time_point::max()) ? -1
+			: static_cast<int>(chrono::duration_cast<chrono::milliseconds>(next - now).count()) + 1;
+
+#if defined(_WIN32)
+		if (timeoutMs < 0) changed.wait(lock);
+		else changed.wait_for(lock, chrono::milliseconds(timeoutMs));
+#else
+		polled.assign(1, pollfd{ wakePipe[0], POLLIN, 0 });
+		owners.clear();
+		for (size_t i = 0; i < sources.size(); ++i) {
+			if (sources[i].fd < 0) continue;
+			polled.push_back(pollfd{ sources[i].fd, POLLIN, 0 });
+			owners.push_back(i);
+		}
+		lock.unlock();
+
+		//Only this thread removes sources, so the indices above stay valid
+		int ready = poll(polled.data(), static_cast<nfds_t>(polled.size()), timeoutMs);
+		if (ready <= 0) continue;
+
+		if (polled[0].revents) {
+			char drain[64];
+			while (::read(wakePipe[0], drain, sizeof(drain)) > 0) {}
+		}
+
+		lock.lock();
+		for (size_t k = owners.size(); k-- > 0;) {
+			if (!polled[k + 1].revents) continue;
+			if (!readSource(sources[owners[k]])) finish(owners[k]);
+		}
+#endif
+	}
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+
+// ------------- Input Channel -------------
+
+enum class InputStatus {
+	Line,
+	Timeout,	//Nothing arrived before the deadline (or yet, for tryRead)
+	Closed		//Source ended and every queued line was read
+};
+
+using InputDeadline = std::chrono::steady_clock::time_point;
+inline constexpr InputDeadline noDeadline = InputDeadline::max();
+
+// Lines from one session in arrival order. An InputLoop fills it from its own
+// thread; the game side either waits with a deadline or polls with tryRead,
+// so a prompt never sits inside a blocking read of its own.
+class InputChannel {
+public:
+	void push(std::string line);
+
+	//Every line of text under one lock; a last line without '\n' counts too
+	void pushText(std::string_view text);
+
+	//No more lines are coming; readers get Closed once the queue is empty
+	void close();
+
+	InputStatus tryRead(std::string& line);
+
+	//timeoutMs <= 0 waits until a line or the end of input
+	InputStatus read(std::string& line, int timeoutMs = 0);
+	InputStatus readUntil(std::string& line, InputDeadline deadline);
+
+	size_t pending() const;
+
+private:
+	mutable std::mutex m;
+	std::condition_variable arrived;
+	std::deque<std::string> lines;
+	bool closed = false;
+};
+
+
+// ------------- Input Loop -------------
+
+// One thread that multiplexes every input source into the channels: terminals,
+// pipes and sockets are polled non-blocking and split into lines, scripted
+// feeds are played back on a timer. Several sources may share a channel and a
+// channel closes when the last of its sources ends.
+class InputLoop {
+public:
+	InputLoop();
+	~InputLoop();
+
+	InputLoop(const InputLoop&) = delete;
+	InputLoop& operator=(const InputLoop&) = delete;
+
+	//Reads fd until end of file; the caller keeps ownership of fd
+	void addFd(int fd, std::shared_ptr<InputChannel> channel);
+
+	//Plays lines into the channel, one every intervalMs (0 = all at once).
+	//Lines added before another source on the same channel come first.
+	void addScript(std::vector<std::string> lines, std::shared_ptr<InputChannel> channel, int intervalMs = 0);
+
+	//Starts the loop thread; sources can still be added afterwards
+	void start();
+
+	//Wakes the thread and waits for it, open channels stay open
+	void stop();
+
+private:
+	struct Source {
+		int fd = -1;						//-1 for a script
+		std::shared_ptr<InputChannel> channel;
+		std::string partial;				//Bytes after the last '\n'
+		std::deque<std::string> script;
+		std::chrono::milliseconds interval{ 0 };
+		std::chrono::steady_clock::time_point due;
+	};
+
+	std::mutex m;
+	std::condition_variable changed;	//Wakes the loop where it can't poll the wake pipe
+	std::vector<Source> sources;
+	std::thread worker;
+	bool stopping = false;
+	int wakePipe[2] = { -1, -1 };
+
+	void run();
+	void wake();
+	void finish(size_t index);
+	bool readSource(Source& source);
+};
@@ -0,0 +1,180 @@
+#include "Mcts.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+using namespace std;
+
+
+namespace {
+	constexpr int ongoing = -2;
+
+	//Winning seat, -1 for a Tie (full board), ongoing otherwise
+	int resultOf(const Position& p) {
+		int winner = winnerOf(p);
+		if (winner >= 0) return winner;
+		return (p.occupied() == Board::fullMask) ? -1 : ongoing;
+	}
+
+	//Random actions until the game ends, except that a placement winning on the spot is always taken
+	int playout(Position p, const Archetype archetypes[2], Rng& rng, int limit) {
+		ActionList actions;
+		for (int ply = 0; ply < limit; ++ply) {
+			Mask own = p.marks[p.side];
+			Mask empty = static_cast<Mask>(~p.occupied() & Board::fullMask);
+			for (int i = 0; i < Board::cells; ++i) {
+				if ((empty & cellBit(i)) && completesLineThrough(static_cast<Mask>(own | cellBit(i)), i)) return p.side;
+			}
+
+			generateActions(p, archetypes[p.side], actions);
+			p = applyAction(p, actions.moves[rng.below(static_cast<uint32_t>(actions.count))]);
+			int result = resultOf(p);
+			if (result != ongoing) return result;
+		}
+		return -1;	//Went on too long, call it a Tie like the Battle turn limit does
+	}
+}
+
+
+// ------------- Monte Carlo Tree Search -------------
+
+void MctsSearch::grow(Tree& tree, const Position& root, const Archetype archetypes[2], uint64_t seed, int iterations,
+					  bool timed, chrono::steady_clock::time_point deadline) const {
+	Rng rng(seed);
+	vector<Node>& arena = tree.arena;
+	if (arena.capacity() < config.maxNodes) arena.reserve(config.maxNodes);	//Never grows past this, so references stay valid
+	arena.clear();
+	arena.push_back(Node{});
+	tree.iterations = 0;
+
+	ActionList actions;
+	vector<pair<uint32_t, int>> path;	//Node and the seat that moved into it (-1 for the root)
+	const double c = config.exploration;
+
+	for (int it = 0; iterations <= 0 || it < iterations; ++it) {
+		if (timed && (it & 63) == 0 && chrono::steady_clock::now() >= deadline) break;
+
+		Position p = root;
+		uint32_t node = 0;
+		path.clear();
+		path.push_back({ 0, -1 });
+		int result = resultOf(p);
+
+		//Selection: unvisited children first, then the best UCT value
+		while (result == ongoing && arena[node].expanded) {
+			const Node& parent = arena[node];
+			double logVisits = log(static_cast<double>(max(parent.visits, 1u)));
+			uint32_t best = parent.firstChild;
+			double bestValue = -1.0;
+			for (uint32_t k = parent.firstChild; k < parent.firstChild + parent.children; ++k) {
+				const Node& child = arena[k];
+				if (child.visits == 0) {
+					best = k;
+					break;
+				}
+				double value = child.score / child.visits + c * sqrt(logVisits / child.visits);
+				if (value > bestValue) {
+					bestValue = value;
+					best = k;
+				}
+			}
+
+			path.push_back({ best, p.side });
+			p = applyAction(p, arena[best].move);
+			node = best;
+			result = resultOf(p);
+		}
+
+		//Expansion: all children at once, while the arena has room for them
+		if (result == ongoing) {
+			generateActions(p, archetypes[p.side], actions);
+			if (actions.count > 0 && arena.size() + actions.count <= config.maxNodes) {
+				uint32_t first = static_cast<uint32_t>(arena.size());
+				for (const Action& a : actions) {
+					Node child;
+					child.move = a;
+					arena.push_back(child);
+				}
+				arena[node].firstChild = first;
+				arena[node].children = static_cast<uint16_t>(actions.count);
+				arena[node].expanded = true;
+
+				uint32_t pick = first + rng.below(static_cast<uint32_t>(actions.count));
+				path.push_back({ pick, p.side });
+				p = applyAction(p, arena[pick].move);
+				result = resultOf(p);
+			}
+		}
+
+		if (result == ongoing) result = playout(p, archetypes, rng, config.playoutLimit);
+
+		for (const auto& step : path) {
+			Node& n = arena[step.first];
+			n.visits++;
+			if (step.second >= 0) n.score += (result == -1) ? 0.5f : (result == step.second) ? 1.0f : 0.0f;
+		}
+		tree.iterations++;
+	}
+}
+
+Action MctsSearch::bestAction(const Position& p, const Archetype archetypes[2], uint64_t seed) {
+	ActionList legal;
+	generateActions(p, archetypes[p.side], legal);
+	lastIterations = 0;
+	lastNodes = 0;
+	lastScore = 0.0;
+	if (legal.count == 0) return Action{};
+
+	int threads = config.threads > 0 ? config.threads : static_cast<int>(max(1u, thread::hardware_concurrency()));
+	if (static_cast<int>(trees.size()) < threads) trees.resize(threads);
+
+	bool timed = config.budgetMs > 0;
+	auto deadline = chrono::steady_clock::now()
+		+ chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double, milli>(config.budgetMs));
+	int iterations = config.iterations;
+	if (iterations <= 0 && !timed) iterations = MctsConfig().iterations;	//Neither limit set
+	int perThread = iterations > 0 ? max(1, (iterations + threads - 1) / threads) : 0;
+
+	//Worker t draws from its own stream, so its tree depends only on (seed, t)
+	auto work = [&](int t) { grow(trees[t], p, archetypes, Rng(seed, static_cast<uint64_t>(t))(), perThread, timed, deadline); };
+	vector<thread> workers;
+	for (int t = 1; t < threads; ++t) workers.emplace_back(work, t);
+	work(0);
+	for (thread& w : workers) w.join();
+
+	//Root children come out of generateActions in the same order in every tree
+	vector<uint64_t> visits(legal.count, 0);
+	vector<double> score(legal.count, 0.0);
+	for (int t = 0; t < threads; ++t) {
+		const Tree& tree = trees[t];
+		lastIterations += tree.iterations;
+		lastNodes += tree.arena.size();
+		const Node& root = tree.arena[0];
+		if (!root.expanded) continue;
+		for (int k = 0; k < root.children; ++k) {
+			visits[k] += tree.arena[root.firstChild + k].visits;
+			score[k] += tree.arena[root.firstChild + k].score;
+		}
+	}
+
+	int best = 0;
+	for (int k = 1; k < legal.count; ++k) {
+		if (visits[k] > visits[best] || (visits[k] == visits[best] && score[k] > score[best])) best = k;
+	}
+	if (visits[best] > 0) lastScore = score[best] / static_cast<double>(visits[best]);
+	return legal.moves[best];
+}
+
+
+// ------------- Controller -------------
+
+Action MctsController::chooseAction(const Observation& obs) {
+	Archetype seats[2] = {
+		obs.battleRules ? obs.self.archetype : Archetype::None,
+		obs.battleRules ? obs.opponent.archetype : Archetype::None
+	};
+	//Seat 0 of the Position is always this player
+	Position p = Position::fromBoard(obs.board, obs.self.mark, obs.opponent.mark, 0);
+	return search.bestAction(p, seats, (rng ? *rng : globalRng())());
+}
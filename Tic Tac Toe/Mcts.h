@@ -0,0 +1,80 @@
+#pragma once
+
+#include "Engine.h"
+
+#include <chrono>
+#include <vector>
+
+
+// ------------- Monte Carlo Tree Search -------------
+
+// UCT with random playouts over Positions, for Battle where swaps and shifts
+// make the game cyclic and too wide to search exhaustively. Each tree lives in
+// a preallocated arena: a node's children are created together and stored
+// side by side, so a node only records where they start. When the arena is
+// full the tree stops growing and later iterations only add playouts.
+//
+// With more than one thread every worker grows its own tree from the root
+// (root parallelization) and the root visit counts are summed. Workers only
+// share the root position, so a fixed iteration budget gives the same move
+// for the same seed and thread count.
+
+struct MctsConfig {
+	int iterations = 20000;			//Over all threads; 0 = until the time budget runs out
+	double budgetMs = 0;			//Think time per move, <= 0 = no limit
+	int threads = 1;				//0 = one per core
+	size_t maxNodes = 1 << 17;		//Arena size per thread
+	int playoutLimit = 60;			//Plies before a playout is scored as a Tie
+	double exploration = 1.4;
+};
+
+class MctsSearch {
+public:
+	explicit MctsSearch(const MctsConfig& config = MctsConfig()) : config(config) {}
+
+	MctsConfig config;
+
+	//Best action for p.side; archetypes by seat (None everywhere for plain games).
+	//seed fixes every playout. Falls back to the first legal action if none was explored.
+	Action bestAction(const Position& p, const Archetype archetypes[2], uint64_t seed);
+
+	// -- Last search --
+	uint64_t lastIterations = 0;	//All threads
+	size_t lastNodes = 0;			//Arena nodes in use, all threads
+	double lastScore = 0.0;			//Expected result of the chosen action for the mover (1 win, 0.5 tie)
+
+private:
+	struct Node {
+		Action move;				//Played to reach this node
+		uint32_t firstChild = 0;
+		uint16_t children = 0;
+		bool expanded = false;
+		uint32_t visits = 0;
+		float score = 0.0f;			//Sum of results for the seat that played move
+	};
+
+	struct Tree {
+		std::vector<Node> arena;	//Capacity reserved once, cleared per search
+		uint64_t iterations = 0;
+	};
+
+	std::vector<Tree> trees;		//One per worker, reused between moves
+
+	void grow(Tree& tree, const Position& root, const Archetype archetypes[2], uint64_t seed, int iterations,
+			  bool timed, std::chrono::steady_clock::time_point deadline) const;
+};
+
+// Plays whatever MctsSearch picks, in plain and Battle games
+class MctsController : public PlayerController {
+public:
+	explicit MctsController(const MctsConfig& config = MctsConfig()) : search(config) {}
+
+	Rng* rng = nullptr;	//Seeds each search; nullptr uses globalRng()
+
+	Action chooseAction(const Observation& obs) override;
+
+	const MctsSearch& getSearch() const { return search; }
+
+private:
+	MctsSearch search;
+};
@@ -0,0 +1,138 @@
+#include "Profile.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+
+using namespace std;
+
+
+// ------------- Phase Names -------------
+
+const char* profilePhaseName(ProfilePhase phase) {
+	switch (phase) {
+		case ProfilePhase::InputWait: return "input_wait";
+		case ProfilePhase::Render: return "render";
+		case ProfilePhase::RuleEval: return "rule_eval";
+		case ProfilePhase::WinCheck: return "win_check";
+		case ProfilePhase::EnemyAbilities: return "enemy_abilities";
+		case ProfilePhase::SaveWrite: return "save_write";
+		case ProfilePhase::SaveLoad: return "save_load";
+		case ProfilePhase::CampaignStage: return "campaign_stage";
+		default: return "unknown";
+	}
+}
+
+
+// ------------- Totals -------------
+
+namespace {
+	struct Totals {
+		mutex lock;
+		ProfileSnapshot stats{};
+	};
+
+	Totals& totals() {
+		static Totals t;
+		return t;
+	}
+
+	void addInto(ProfileSnapshot& into, const ProfileSnapshot& from) {
+		for (size_t i = 0; i < into.size(); ++i) {
+			into[i].calls += from[i].calls;
+			into[i].totalNs += from[i].totalNs;
+			if (from[i].maxNs > into[i].maxNs) into[i].maxNs = from[i].maxNs;
+		}
+	}
+
+	string exportPath;
+
+	void dumpNow() {
+		//The main thread's shard was folded in before exit handlers run
+		ProfileSnapshot snap;
+		{
+			lock_guard<mutex> guard(totals().lock);
+			snap = totals().stats;
+		}
+
+		Profiler::printSummary(cerr, snap);
+		if (exportPath.empty()) return;
+
+		ofstream file(exportPath);
+		Profiler::writeJson(file, snap);
+		if (!file) cerr << "(Warning: could not write " << exportPath << ".)\n";
+	}
+}
+
+Profiler::Shard::~Shard() {
+	fold(stats);
+}
+
+void Profiler::fold(ProfileSnapshot& stats) {
+	lock_guard<mutex> guard(totals().lock);
+	addInto(totals().stats, stats);
+	stats = ProfileSnapshot{};
+}
+
+ProfileSnapshot Profiler::snapshot() {
+	ProfileSnapshot snap;
+	{
+		lock_guard<mutex> guard(totals().lock);
+		snap = totals().stats;
+	}
+	addInto(snap, shard().stats);
+	return snap;
+}
+
+void Profiler::reset() {
+	lock_guard<mutex> guard(totals().lock);
+	totals().stats = ProfileSnapshot{};
+	shard().stats = ProfileSnapshot{};
+}
+
+
+// ------------- Output -------------
+
+void Profiler::printSummary(ostream& out, const ProfileSnapshot& snap) {
+	out << "\n -- Profile --\n"
+		<< left << setw(18) << "phase" << right << setw(12) << "calls"
+		<< setw(14) << "total ms" << setw(14) << "mean us" << setw(14) << "max us" << "\n";
+
+	for (size_t i = 0; i < snap.size(); ++i) {
+		const PhaseStats& s = snap[i];
+		if (s.calls == 0) continue;
+
+		out << left << setw(18) << profilePhaseName(static_cast<ProfilePhase>(i)) << right << setw(12) << s.calls;
+		if (s.totalNs == 0) {
+			out << setw(14) << "-" << setw(14) << "-" << setw(14) << "-" << "\n";	//Counter only
+			continue;
+		}
+		out << fixed << setprecision(3)
+			<< setw(14) << s.totalNs / 1e6
+			<< setw(14) << s.totalNs / 1e3 / static_cast<double>(s.calls)
+			<< setw(14) << s.maxNs / 1e3 << "\n";
+		out.unsetf(ios::floatfield);
+	}
+}
+
+//Same shape as the benchmark export: fixed key order, every phase listed
+void Profiler::writeJson(ostream& out, const ProfileSnapshot& snap) {
+	out << "{\n  \"schema\": 1,\n  \"phases\": [\n";
+	for (size_t i = 0; i < snap.size(); ++i) {
+		const PhaseStats& s = snap[i];
+		out << "    {\"name\": \"" << profilePhaseName(static_cast<ProfilePhase>(i)) << "\""
+			<< ", \"calls\": " << s.calls
+			<< ", \"total_ns\": " << s.totalNs
+			<< ", \"max_ns\": " << s.maxNs << "}"
+			<< (i + 1 < snap.size() ? ",\n" : "\n");
+	}
+	out << "  ]\n}\n";
+}
+
+void Profiler::dumpAtExit(const string& jsonPath) {
+	exportPath = jsonPath;
+	totals();	//Built before the handler is registered, so it outlives it
+	atexit(dumpNow);
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+// Build with TTT_PROFILING=1 (CMake: -DTTT_ENABLE_PROFILING=ON) to compile the
+// timers and counters in; otherwise every TTT_PROFILE_* macro expands to nothing.
+#ifndef TTT_PROFILING
+#define TTT_PROFILING 0
+#endif
+
+
+// ------------- Profiling Phases -------------
+
+enum class ProfilePhase {
+	InputWait,		//promptMove, waiting on the player
+	Render,			//printBoard and BoardRenderer::draw
+	RuleEval,		//Validating and applying an action
+	WinCheck,		//Board::winner calls (counted, too cheap to time)
+	EnemyAbilities,	//handleEnemyAbilities
+	SaveWrite,		//saveGame
+	SaveLoad,		//loadGame
+	CampaignStage,	//One pass of the campaign stage loop
+	Count
+};
+
+const char* profilePhaseName(ProfilePhase phase);
+
+struct PhaseStats {
+	uint64_t calls = 0;
+	uint64_t totalNs = 0;
+	uint64_t maxNs = 0;
+};
+
+using ProfileSnapshot = std::array<PhaseStats, static_cast<size_t>(ProfilePhase::Count)>;
+
+
+// ------------- Profiler -------------
+
+// Each thread records into its own shard, no shared cache line on the hot path.
+// A shard is folded into the totals when its thread exits, so a snapshot holds
+// every finished thread plus the caller.
+class Profiler {
+public:
+	static constexpr bool enabled = TTT_PROFILING != 0;
+
+	static void record(ProfilePhase phase, uint64_t ns) {
+		PhaseStats& s = shard().stats[static_cast<size_t>(phase)];
+		++s.calls;
+		s.totalNs += ns;
+		if (ns > s.maxNs) s.maxNs = ns;
+	}
+
+	static void count(ProfilePhase phase) {
+		++shard().stats[static_cast<size_t>(phase)].calls;
+	}
+
+	static ProfileSnapshot snapshot();
+	static void reset();
+
+	static void printSummary(std::ostream& out, const ProfileSnapshot& snap);
+	static void writeJson(std::ostream& out, const ProfileSnapshot& snap);
+
+	//Summary to stderr at exit, plus a JSON export when path isn't empty
+	static void dumpAtExit(const std::string& jsonPath);
+
+private:
+	struct Shard {
+		ProfileSnapshot stats{};
+		~Shard();
+	};
+
+	static Shard& shard() {
+		thread_local Shard s;
+		return s;
+	}
+
+	static void fold(ProfileSnapshot& stats);
+};
+
+// Times the enclosing scope into one phase
+class ScopedTimer {
+public:
+	explicit ScopedTimer(ProfilePhase phase) : phase(phase), start(std::chrono::steady_clock::now()) {}
+	~ScopedTimer() {
+		auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+		Profiler::record(phase, static_cast<uint64_t>(ns));
+	}
+
+	ScopedTimer(const ScopedTimer&) = delete;
+	ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+	ProfilePhase phase;
+	std::chrono::steady_clock::time_point start;
+};
+
+
+// -- Macros --
+
+#define TTT_PROFILE_CONCAT_(a, b) a##b
+#define TTT_PROFILE_CONCAT(a, b) TTT_PROFILE_CONCAT_(a, b)
+
+#if TTT_PROFILING
+#define TTT_PROFILE_SCOPE(phase) ScopedTimer TTT_PROFILE_CONCAT(profileTimer_, __LINE__)(ProfilePhase::phase)
+#define TTT_PROFILE_COUNT(phase) Profiler::count(ProfilePhase::phase)
+#else
+#define TTT_PROFILE_SCOPE(phase) ((void)0)
+#define TTT_PROFILE_COUNT(phase) ((void)0)
+#endif
@@ -0,0 +1,492 @@
+#include "Replay.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+
+using namespace std;
+
+
+namespace {
+
+	constexpr char replayMagic[4] = { 'T', 'T', 'T', 'R' };
+	constexpr uint8_t replayVersion = 1;
+
+	//seat:1 | type:2 | a:4, b follows for swaps and shifts
+	uint8_t packAction(int seat, const Action& a) {
+		return static_cast<uint8_t>((seat & 1) << 7 | (static_cast<int>(a.type) & 3) << 4 | (a.a & 0xF));
+	}
+}
+
+
+// ------------- Writing -------------
+
+void ReplayWriter::putVarint(uint64_t v) {
+	while (v >= 0x80) {
+		putByte(static_cast<uint8_t>(v | 0x80));
+		v >>= 7;
+	}
+	putByte(static_cast<uint8_t>(v));
+}
+
+void ReplayWriter::putString(const string& s) {
+	putVarint(s.size());
+	buffer.append(s);
+}
+
+void ReplayWriter::putPlayer(const Player& p) {
+	putString(p.name);
+	putByte(static_cast<uint8_t>(p.mark));
+	putByte(static_cast<uint8_t>(p.archetype));
+}
+
+void ReplayWriter::beginBlock(ReplayKind kind) {
+	buffer.append(replayMagic, sizeof(replayMagic));
+	putByte(replayVersion);
+	putByte(static_cast<uint8_t>(kind));
+}
+
+void ReplayWriter::beginMatch(const Player& p0, const Player& p1, bool battleRules, int turnLimit) {
+	beginBlock(ReplayKind::Match);
+	putByte(static_cast<uint8_t>(ReplayTag::MatchStart));
+	putByte(battleRules ? 1 : 0);
+	putVarint(static_cast<uint64_t>(turnLimit));
+	putPlayer(p0);
+	putPlayer(p1);
+}
+
+void ReplayWriter::beginCampaign(const Rng& rng, int roundLimit) {
+	beginBlock(ReplayKind::Campaign);
+	putByte(static_cast<uint8_t>(ReplayTag::CampaignStart));
+	putVarint(rng.getKey());
+	putVarint(rng.getCounter());
+	putVarint(static_cast<uint64_t>(roundLimit));
+}
+
+void ReplayWriter::loadedSave(const CampaignSaveData& data) {
+	SaveRecord record = makeSaveRecord(data);
+	putByte(static_cast<uint8_t>(ReplayTag::LoadedSave));
+	buffer.append(reinterpret_cast<const char*>(&record), sizeof(record));
+}
+
+void ReplayWriter::decision(ReplayDecision d, int value, const string& text) {
+	putByte(static_cast<uint8_t>(ReplayTag::Decision));
+	putByte(static_cast<uint8_t>(d));
+	putSigned(value);
+	if (d == ReplayDecision::CreateHero) putString(text);
+}
+
+void ReplayWriter::action(int seat, const Action& a) {
+	putByte(static_cast<uint8_t>(ReplayTag::Action));
+	putByte(packAction(seat, a));
+	if (a.type != ActionType::Place) putByte(static_cast<uint8_t>(a.b));
+}
+
+void ReplayWriter::roundEnd(int winnerSeat, int turns) {
+	putByte(static_cast<uint8_t>(ReplayTag::RoundEnd));
+	putSigned(winnerSeat);
+	putVarint(static_cast<uint64_t>(turns));
+}
+
+void ReplayWriter::endGame(int result, int length) {
+	putByte(static_cast<uint8_t>(ReplayTag::GameEnd));
+	putSigned(result);
+	putVarint(static_cast<uint64_t>(length));
+}
+
+bool ReplayWriter::appendTo(const string& path) {
+	ofstream file(path, ios::binary | ios::app);
+	if (!file) return false;
+
+	file.write(buffer.data(), static_cast<streamsize>(buffer.size()));
+	file.flush();
+	if (!file) return false;
+
+	buffer.clear();
+	return true;
+}
+
+
+// ------------- Reading -------------
+
+namespace {
+
+	class ByteReader {
+	public:
+		ByteReader(const string& bytes) : p(bytes.data()), end(bytes.data() + bytes.size()) {}
+
+		bool ok = true;
+
+		bool atEnd() const { return p >= end; }
+
+		uint8_t byte() {
+			if (p >= end) {
+				ok = false;
+				return 0;
+			}
+			return static_cast<uint8_t>(*p++);
+		}
+
+		uint64_t varint() {
+			uint64_t v = 0;
+			for (int shift = 0; shift < 64; shift += 7) {
+				uint8_t b = byte();
+				v |= static_cast<uint64_t>(b & 0x7F) << shift;
+				if (!(b & 0x80)) return v;
+			}
+			ok = false;
+			return v;
+		}
+
+		int64_t signedVarint() {
+			uint64_t z = varint();
+			return static_cast<int64_t>(z >> 1) ^ -static_cast<int64_t>(z & 1);
+		}
+
+		string text() {
+			uint64_t len = varint();
+			if (!ok || len > static_cast<uint64_t>(end - p)) {
+				ok = false;
+				return string();
+			}
+			string s(p, static_cast<size_t>(len));
+			p += len;
+			return s;
+		}
+
+		void raw(void* out, size_t n) {
+			if (static_cast<size_t>(end - p) < n) {
+				ok = false;
+				return;
+			}
+			memcpy(out, p, n);
+			p += n;
+		}
+
+	private:
+		const char* p;
+		const char* end;
+	};
+
+	Player readPlayer(ByteReader& in) {
+		Player p;
+		p.name = in.text();
+		p.mark = static_cast<char>(in.byte());
+		p.archetype = static_cast<Archetype>(in.byte());
+		return p;
+	}
+
+	bool readEvent(ByteReader& in, ReplayEvent& e) {
+		e.tag = static_cast<ReplayTag>(in.byte());
+
+		switch (e.tag) {
+		case ReplayTag::MatchStart:
+			e.battleRules = in.byte() != 0;
+			e.turnLimit = static_cast<int>(in.varint());
+			e.players[0] = readPlayer(in);
+			e.players[1] = readPlayer(in);
+			break;
+		case ReplayTag::CampaignStart:
+			e.rngKey = in.varint();
+			e.rngCounter = in.varint();
+			e.roundLimit = static_cast<int>(in.varint());
+			break;
+		case ReplayTag::LoadedSave:
+			in.raw(&e.save, sizeof(e.save));
+			break;
+		case ReplayTag::Decision:
+			e.decision = static_cast<ReplayDecision>(in.byte());
+			e.value = static_cast<int>(in.signedVarint());
+			if (e.decision == ReplayDecision::CreateHero) e.text = in.text();
+			break;
+		case ReplayTag::Action: {
+			uint8_t packed = in.byte();
+			e.seat = packed >> 7;
+			e.action.type = static_cast<ActionType>((packed >> 4) & 3);
+			e.action.a = static_cast<int8_t>(packed & 0xF);
+			e.action.b = (e.action.type != ActionType::Place) ? static_cast<int8_t>(in.byte()) : -1;
+			break;
+		}
+		case ReplayTag::RoundEnd:
+		case ReplayTag::GameEnd:
+			e.value = static_cast<int>(in.signedVarint());
+			e.length = static_cast<int>(in.varint());
+			break;
+		default:
+			return false;
+		}
+		return in.ok;
+	}
+}
+
+bool parseReplays(const string& bytes, vector<ReplayGame>& games) {
+	ByteReader in(bytes);
+
+	while (!in.atEnd()) {
+		char magic[sizeof(replayMagic)];
+		in.raw(magic, sizeof(magic));
+		if (!in.ok || memcmp(magic, replayMagic, sizeof(magic)) != 0) return false;
+		if (in.byte() != replayVersion) return false;
+
+		ReplayGame game;
+		game.kind = static_cast<ReplayKind>(in.byte());
+
+		//A block always closes with GameEnd; a crash mid-game leaves it open
+		ReplayEvent e;
+		do {
+			e = ReplayEvent();
+			if (!readEvent(in, e)) return false;
+			game.events.push_back(e);
+		} while (e.tag != ReplayTag::GameEnd);
+
+		games.push_back(move(game));
+	}
+	return true;
+}
+
+bool readReplayFile(const string& path, vector<ReplayGame>& games) {
+	ifstream file(path, ios::binary);
+	if (!file) return false;
+
+	string bytes((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+	return parseReplays(bytes, games);
+}
+
+
+// ------------- Replaying -------------
+
+namespace {
+
+	// Walks the events in order; every consumer expects the next one to be its own
+	class ReplayCursor {
+	public:
+		ReplayCursor(const vector<ReplayEvent>& events, ReplayResult& result, size_t start)
+			: events(events), result(result), pos(start) {}
+
+		bool diverged() const { return !result.matched; }
+
+		const ReplayEvent* peek(ReplayTag tag) const {
+			if (diverged() || pos >= events.size() || events[pos].tag != tag) return nullptr;
+			return &events[pos];
+		}
+
+		const ReplayEvent* next(ReplayTag tag, const char* what) {
+			const ReplayEvent* e = peek(tag);
+			if (e) {
+				++pos;
+			}
+			else {
+				diverge(string("expected ") + what);
+			}
+			return e;
+		}
+
+		void diverge(const string& why) {
+			if (diverged()) return;
+			result.matched = false;
+			result.divergedAt = pos;
+			result.reason = why;
+		}
+
+	private:
+		const vector<ReplayEvent>& events;
+		ReplayResult& result;
+		size_t pos;
+	};
+
+	// Plays the logged actions for one seat, the first legal action once the log no longer fits
+	class ReplayPlayerController : public PlayerController {
+	public:
+		ReplayPlayerController(ReplayCursor& cursor, int seat) : cursor(cursor), seat(seat) {}
+
+		Action chooseAction(const Observation& obs) override {
+			const ReplayEvent* e = cursor.peek(ReplayTag::Action);
+			if (e && e->seat == seat) return e->action;
+			cursor.diverge("expected an action from seat " + to_string(seat + 1));
+
+			char mark0 = (obs.seat == 0) ? obs.self.mark : obs.opponent.mark;
+			char mark1 = (obs.seat == 0) ? obs.opponent.mark : obs.self.mark;
+			ActionList legal;
+			generateActions(Position::fromBoard(obs.board, mark0, mark1, obs.seat), obs.battleRules ? obs.self.archetype : Archetype::None, legal);
+			return legal.moves[0];
+		}
+
+		void onRejected(const Observation&, const Action&, ActionError) override {
+			cursor.diverge("logged action is no longer legal");
+		}
+
+	private:
+		ReplayCursor& cursor;
+		int seat;
+	};
+
+	// Checks every action and board result against the log
+	class ReplayVerifier : public MatchListener {
+	public:
+		explicit ReplayVerifier(ReplayCursor& cursor) : cursor(cursor) {}
+
+		void onAction(const Board&, const Player&, int seat, const Action& action) override {
+			if (cursor.diverged()) return;
+			const ReplayEvent* e = cursor.next(ReplayTag::Action, "an action");
+			if (e && (e->seat != seat || e->action != action)) cursor.diverge("seat " + to_string(seat + 1) + " played a different action");
+		}
+
+		void onGameOver(const Board&, const GameOutcome& outcome) override {
+			if (!roundEnds || cursor.diverged()) return;
+			const ReplayEvent* e = cursor.next(ReplayTag::RoundEnd, "the round to end");
+			if (e && (e->value != outcome.winnerSeat || e->length != outcome.turns)) cursor.diverge("round ended differently");
+		}
+
+		bool roundEnds = true;	//Matches close with GameEnd instead
+
+	private:
+		ReplayCursor& cursor;
+	};
+
+	// Answers every campaign question from the log
+	class ReplayCampaignController : public CampaignController {
+	public:
+		explicit ReplayCampaignController(ReplayCursor& cursor) : cursor(cursor), hero(cursor, 0), verifier(cursor) {}
+
+		bool continueSavedCampaign(const Player&, int) override { return answer(ReplayDecision::ContinueSaved, 1) != 0; }
+
+		void createHero(string& name, Archetype& archetype) override {
+			const ReplayEvent* e = decision(ReplayDecision::CreateHero);
+			name = e ? e->text : "Hero";
+			archetype = e ? static_cast<Archetype>(e->value) : Archetype::Alchemist;
+		}
+
+		EnemyStrategy chooseEnemyStrategy() override { return static_cast<EnemyStrategy>(answer(ReplayDecision::EnemyStrategy, 0)); }
+		bool quitBeforeBattle(int) override { return answer(ReplayDecision::QuitBeforeBattle, 1) != 0; }	//Quit early once diverged
+		CampaignPath choosePath() override { return static_cast<CampaignPath>(answer(ReplayDecision::Path, 0)); }
+		bool touchShrine() override { return answer(ReplayDecision::Shrine, 0) != 0; }
+
+		PlayerController& heroController() override { return hero; }
+		MatchListener* roundListener() override { return &verifier; }
+
+	private:
+		ReplayCursor& cursor;
+		ReplayPlayerController hero;
+		ReplayVerifier verifier;
+
+		const ReplayEvent* decision(ReplayDecision d) {
+			if (cursor.diverged()) return nullptr;
+			const ReplayEvent* e = cursor.next(ReplayTag::Decision, "a campaign decision");
+			if (e && e->decision != d) {
+				cursor.diverge("campaign asked a different question");
+				return nullptr;
+			}
+			return e;
+		}
+
+		int answer(ReplayDecision d, int fallback) {
+			const ReplayEvent* e = decision(d);
+			return e ? e->value : fallback;
+		}
+	};
+
+	void checkGameEnd(ReplayCursor& cursor, int result, int length) {
+		const ReplayEvent* e = cursor.next(ReplayTag::GameEnd, "the game to end");
+		if (e && (e->value != result || e->length != length)) cursor.diverge("game ended differently");
+	}
+}
+
+ReplayResult replayGame(const ReplayGame& game) {
+	ReplayResult result;
+	result.kind = game.kind;
+	const vector<ReplayEvent>& events = game.events;
+
+	if (events.empty()) {
+		result.matched = false;
+		result.reason = "empty log";
+		return result;
+	}
+
+	if (game.kind == ReplayKind::Match) {
+		ReplayCursor cursor(events, result, 1);
+		if (events[0].tag != ReplayTag::MatchStart) {
+			cursor.diverge("log doesn't start with a match");
+			return result;
+		}
+
+		ReplayPlayerController seats[2] = { ReplayPlayerController(cursor, 0), ReplayPlayerController(cursor, 1) };
+		ReplayVerifier verifier(cursor);
+		verifier.roundEnds = false;
+
+		TicTacToeGame match;
+		match.setPlayer(0, events[0].players[0], seats[0]);
+		match.setPlayer(1, events[0].players[1], seats[1]);
+		match.setBattleRules(events[0].battleRules);
+		match.setTurnLimit(events[0].turnLimit);
+		match.setListener(&verifier);
+
+		GameOutcome outcome = match.run();
+		result.result = outcome.winnerSeat;
+		result.length = outcome.turns;
+		if (!cursor.diverged()) checkGameEnd(cursor, result.result, result.length);
+		return result;
+	}
+
+	size_t start = 1;
+	CampaignSaveData loaded;
+	bool hasSave = events.size() > 1 && events[1].tag == ReplayTag::LoadedSave;
+	if (hasSave) {
+		readSaveRecord(events[1].save, loaded);
+		start = 2;
+	}
+
+	ReplayCursor cursor(events, result, start);
+	if (events[0].tag != ReplayTag::CampaignStart) {
+		cursor.diverge("log doesn't start with a campaign");
+		return result;
+	}
+
+	//Enemy moves aren't logged but replayed: every campaign enemy stops on depth or iterations, never the clock
+	NullStream quiet;
+	ReplayCampaignController controller(cursor);
+	CampaignGame campaign(controller, quiet);
+	campaign.savePath.clear();
+	campaign.legacySavePath.clear();
+	campaign.setRng(Rng::fromState(events[0].rngKey, events[0].rngCounter));
+	campaign.roundLimit = events[0].roundLimit;
+	if (hasSave) campaign.resumeFrom = &loaded;
+
+	CampaignResult r = campaign.run();
+	result.result = static_cast<int>(r);
+	result.length = campaign.getSummary().endStage;
+	if (!cursor.diverged()) checkGameEnd(cursor, result.result, result.length);
+	return result;
+}
+
+int runReplayCommand(int argc, char* argv[]) {
+	if (argc < 1) {
+		cerr << "Usage: --replay <file> [--verbose]\n";
+		return 1;
+	}
+
+	bool verbose = (argc > 1 && string(argv[1]) == "--verbose");
+
+	vector<ReplayGame> games;
+	if (!readReplayFile(argv[0], games)) {
+		cerr << "Could not read " << argv[0] << (games.empty() ? "\n" : " past the last complete game\n");
+		if (games.empty()) return 1;
+	}
+
+	int diverged = 0;
+	for (size_t i = 0; i < games.size(); ++i) {
+		ReplayResult r = replayGame(games[i]);
+		if (!r.matched) ++diverged;
+
+		if (verbose || !r.matched) {
+			cout << "Game " << (i + 1) << " (" << (r.kind == ReplayKind::Match ? "match" : "campaign") << "): ";
+			if (r.matched) cout << "reproduced";
+			else cout << "DIVERGED at event " << r.divergedAt << ", " << r.reason;
+			cout << "\n";
+		}
+	}
+
+	cout << games.size() << " games replayed, " << (games.size() - diverged) << " reproduced, " << diverged << " diverged\n";
+	return diverged ? 2 : 0;
+}
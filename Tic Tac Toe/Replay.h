@@ -0,0 +1,115 @@
+#pragma once
+
+#include "Engine.h"
+#include "SaveFile.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+// ------------- Replay Log -------------
+
+// Append-only record of everything a game depends on: both seats' actions,
+// the campaign's starting Rng state, a loaded save and every controller
+// decision (hero, difficulty, quits, paths, shrines). Each game is its own
+// block, so a corpus file is just recordings appended one after another.
+// Encoding: tag byte + LEB128 varints; a regular placement is two bytes.
+// TicTacToeGame and CampaignGame write the log themselves once given a writer.
+
+enum class ReplayKind : uint8_t { Match = 1, Campaign = 2 };
+
+enum class ReplayTag : uint8_t {
+	MatchStart = 1,		//Both players, battle rules, turn limit
+	CampaignStart,		//Rng key + counter before any save was loaded, round limit
+	LoadedSave,			//SaveRecord the campaign resumed from
+	Decision,			//One CampaignController answer
+	Action,				//One seat's action
+	RoundEnd,			//Winner seat + turns of a board (campaign rounds and matches)
+	GameEnd				//Result + stage (campaign) or winner seat + turns (match)
+};
+
+enum class ReplayDecision : uint8_t {
+	ContinueSaved, CreateHero, EnemyStrategy, QuitBeforeBattle, Path, Shrine
+};
+
+struct ReplayEvent {
+	ReplayTag tag = ReplayTag::Action;
+
+	// -- Action / RoundEnd / GameEnd --
+	int seat = 0;
+	Action action;
+	int value = 0;		//Decision answer, winner seat or campaign result
+	int length = 0;		//Turns or stage
+
+	// -- Decision --
+	ReplayDecision decision = ReplayDecision::ContinueSaved;
+	std::string text;	//Hero name
+
+	// -- MatchStart --
+	Player players[2];
+	bool battleRules = false;
+	int turnLimit = 0;
+
+	// -- CampaignStart / LoadedSave --
+	uint64_t rngKey = 0;
+	int roundLimit = 0;
+	uint64_t rngCounter = 0;
+	SaveRecord save;
+};
+
+struct ReplayGame {
+	ReplayKind kind = ReplayKind::Match;
+	std::vector<ReplayEvent> events;
+};
+
+class ReplayWriter {
+public:
+	void beginMatch(const Player& p0, const Player& p1, bool battleRules, int turnLimit);
+	void beginCampaign(const Rng& rng, int roundLimit);
+	void loadedSave(const CampaignSaveData& data);
+	void decision(ReplayDecision d, int value, const std::string& text = "");
+	void action(int seat, const Action& a);
+	void roundEnd(int winnerSeat, int turns);
+	void endGame(int result, int length);
+
+	//Encoded bytes so far, one or more complete game blocks
+	const std::string& data() const { return buffer; }
+	void clear() { buffer.clear(); }
+
+	//Appends the buffer to the file and clears it
+	bool appendTo(const std::string& path);
+
+private:
+	std::string buffer;
+
+	void putByte(uint8_t b) { buffer.push_back(static_cast<char>(b)); }
+	void putVarint(uint64_t v);
+	void putSigned(int64_t v) { putVarint((static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63)); }
+	void putString(const std::string& s);
+	void putPlayer(const Player& p);
+	void beginBlock(ReplayKind kind);
+};
+
+//Every game block in the bytes / file, false if the data is truncated or not a replay
+bool parseReplays(const std::string& bytes, std::vector<ReplayGame>& games);
+bool readReplayFile(const std::string& path, std::vector<ReplayGame>& games);
+
+
+// ------------- Replaying -------------
+
+struct ReplayResult {
+	ReplayKind kind = ReplayKind::Match;
+	bool matched = true;		//Every action and outcome reproduced
+	size_t divergedAt = 0;		//Event index of the first mismatch
+	std::string reason;
+	int result = 0;				//Winner seat (match) or CampaignResult
+	int length = 0;				//Turns (match) or end stage (campaign)
+};
+
+//Rebuilds the game headlessly from its log and checks it plays out the same
+ReplayResult replayGame(const ReplayGame& game);
+
+//Entry point for "--replay <file> [--verbose]"
+int runReplayCommand(int argc, char* argv[]);
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+
+
+// ------------- Random Number Engine -------------
+
+// Counter-based engine: output n is a pure function of (key, n). One seed can
+// hand out any number of independent streams (one per game or per thread), a
+// stream can jump ahead in O(1), and its whole state is two integers, so a
+// game replays bit for bit from (seed, stream). Works with <random>
+// distributions like any other UniformRandomBitGenerator.
+class Rng {
+public:
+	using result_type = uint64_t;
+
+	Rng() : Rng(0) {}
+	explicit Rng(uint64_t seed, uint64_t stream = 0) { reseed(seed, stream); }
+
+	void reseed(uint64_t seed, uint64_t stream = 0) {
+		key = mix(seed ^ mix(stream + golden));
+		counter = 0;
+	}
+
+	static constexpr result_type min() { return 0; }
+	static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+	result_type operator()() { return mix(key + golden * ++counter); }
+
+	void discard(uint64_t n) { counter += n; }
+
+	//Uniform in [0, n) from the top 32 bits; identical on every compiler, unlike <random> distributions
+	uint32_t below(uint32_t n) {
+		return static_cast<uint32_t>(((*this)() >> 32) * n >> 32);
+	}
+
+	// -- Saved State --
+	uint64_t getKey() const { return key; }
+	uint64_t getCounter() const { return counter; }
+	static Rng fromState(uint64_t key, uint64_t counter) {
+		Rng r;
+		r.key = key;
+		r.counter = counter;
+		return r;
+	}
+
+	bool operator==(const Rng& o) const { return key == o.key && counter == o.counter; }
+	bool operator!=(const Rng& o) const { return !(*this == o); }
+
+	//SplitMix64 finaliser, also used to fill fixed key tables
+	static constexpr uint64_t mix(uint64_t z) {
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return z ^ (z >> 31);
+	}
+
+private:
+	static constexpr uint64_t golden = 0x9E3779B97F4A7C15ull;
+
+	uint64_t key = 0;
+	uint64_t counter = 0;
+};
+
+
+// ------------- Digests -------------
+
+// 64-bit FNV-1a, for checking that two runs played the same games
+constexpr uint64_t fnvOffset = 0xCBF29CE484222325ull;
+constexpr uint64_t fnvPrime = 0x100000001B3ull;
+
+//Hashes value's 8 bytes into h, low byte first
+inline uint64_t fnvFold(uint64_t h, uint64_t value) {
+	for (int i = 0; i < 8; ++i, value >>= 8) {
+		h = (h ^ (value & 0xFF)) * fnvPrime;
+	}
+	return h;
+}
@@ -0,0 +1,117 @@
+#include "Rules.h"
+
+#include <algorithm>
+
+using namespace std;
+
+
+int winnerOf(const Position& p) {
+	for (Mask line : win_masks) {
+		if ((p.marks[0] & line) == line) return 0;
+		if ((p.marks[1] & line) == line) return 1;
+	}
+	return -1;
+}
+
+void generateActions(const Position& p, Archetype arch, ActionList& out) {
+	out.count = 0;
+	Mask occupied = p.occupied();
+	Mask empty = static_cast<Mask>(~occupied & Board::fullMask);
+
+	for (int i = 0; i < 9; ++i) {
+		if (empty & cellBit(i)) out.push(ActionType::Place, i);
+	}
+
+	//Alchemist: two occupied cells holding different marks
+	if (arch == Archetype::Alchemist) {
+		for (int a = 0; a < 9; ++a) {
+			if (!(p.marks[0] & cellBit(a))) continue;
+			for (int b = 0; b < 9; ++b) {
+				if (p.marks[1] & cellBit(b)) out.push(ActionType::Swap, min(a, b), max(a, b));
+			}
+		}
+	}
+
+	//Paladin: any occupied cell to an adjacent empty one
+	if (arch == Archetype::Paladin) {
+		for (int from = 0; from < 9; ++from) {
+			if (!(occupied & cellBit(from))) continue;
+			Mask targets = static_cast<Mask>(adjacency_masks[from] & empty);
+			for (int to = 0; to < 9; ++to) {
+				if (targets & cellBit(to)) out.push(ActionType::Shift, from, to);
+			}
+		}
+	}
+}
+
+Position applyAction(Position p, const Action& m) {
+	Mask a = cellBit(m.a);
+	switch (m.type) {
+	case ActionType::Place:
+		p.marks[p.side] |= a;
+		break;
+	case ActionType::Swap: {
+		Mask both = static_cast<Mask>(a | cellBit(m.b));
+		p.marks[0] ^= both; //Each cell changes owner
+		p.marks[1] ^= both;
+		break;
+	}
+	case ActionType::Shift: {
+		int owner = (p.marks[0] & a) ? 0 : 1;
+		p.marks[owner] = static_cast<Mask>((p.marks[owner] & ~a) | cellBit(m.b));
+		break;
+	}
+	}
+	p.side ^= 1;
+	return p;
+}
+
+void applyAction(Board& board, const Action& m, char mark) {
+	switch (m.type) {
+	case ActionType::Place:
+		board.set(m.a, mark);
+		break;
+	case ActionType::Swap:
+		board.swapCells(m.a, m.b);
+		break;
+	case ActionType::Shift:
+		board.moveCell(m.a, m.b);
+		break;
+	}
+}
+
+char winnerAfter(const Board& board, const Action& m) {
+	if (m.type == ActionType::Place) return board.winnerThrough(m.a);
+	return board.winner();
+}
+
+ActionError validateAction(const Board& board, const Action& m, Archetype arch) {
+	auto onBoard = [](int idx) { return 0 <= idx && idx < 9; };
+
+	switch (m.type) {
+	case ActionType::Place:
+		if (!onBoard(m.a)) return ActionError::OutOfRange;
+		if (board.get(m.a) != ' ') return ActionError::CellOccupied;
+		return ActionError::None;
+
+	case ActionType::Swap:
+		if (arch != Archetype::Alchemist) return ActionError::NotAllowed;
+		if (board.countPlaced() < 2) return ActionError::TooFewMarks;
+		if (!onBoard(m.a) || !onBoard(m.b)) return ActionError::OutOfRange;
+		if (board.get(m.a) == ' ' || board.get(m.b) == ' ') return ActionError::CellEmpty;
+		if (m.a == m.b) return ActionError::SameCell;
+		if (board.get(m.a) == board.get(m.b)) return ActionError::SameMarks;
+		return ActionError::None;
+
+	case ActionType::Shift:
+		if (arch != Archetype::Paladin) return ActionError::NotAllowed;
+		if (board.countPlaced() < 1) return ActionError::TooFewMarks;
+		if (!onBoard(m.a) || !onBoard(m.b)) return ActionError::OutOfRange;
+		if (board.get(m.a) == ' ') return ActionError::CellEmpty;
+		if (m.a == m.b) return ActionError::SameCell;
+		if (!isAdjacent(m.a, m.b)) return ActionError::NotAdjacent;
+		if (board.get(m.b) != ' ') return ActionError::CellOccupied;
+		return ActionError::None;
+	}
+	return ActionError::NotAllowed;
+}
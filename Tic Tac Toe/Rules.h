@@ -0,0 +1,96 @@
+#pragma once
+
+#include "Board.h"
+
+
+// ------------- Archetypes -------------
+
+enum class Archetype {
+	None,
+	Alchemist,
+	Paladin
+};
+
+
+// ------------- Actions -------------
+
+// One turn of any mode as a compact struct. Regular games only ever Place;
+// Battle adds the Alchemist swap and the Paladin shift.
+enum class ActionType : uint8_t {
+	Place,	//a = cell
+	Swap,	//Alchemist: a <-> b
+	Shift	//Paladin: a -> b
+};
+
+struct Action {
+	ActionType type = ActionType::Place;
+	int8_t a = -1;
+	int8_t b = -1;
+
+	static Action place(int cell) { return Action{ ActionType::Place, static_cast<int8_t>(cell), -1 }; }
+	static Action swap(int a, int b) { return Action{ ActionType::Swap, static_cast<int8_t>(a), static_cast<int8_t>(b) }; }
+	static Action shift(int from, int to) { return Action{ ActionType::Shift, static_cast<int8_t>(from), static_cast<int8_t>(to) }; }
+
+	bool operator==(const Action& o) const { return type == o.type && a == o.a && b == o.b; }
+	bool operator!=(const Action& o) const { return !(*this == o); }
+};
+
+struct ActionList {
+	std::array<Action, 96> moves;	//9 places + 20 swaps or 72 shifts at most
+	int count = 0;
+
+	void push(ActionType type, int a, int b = -1) {
+		moves[count++] = Action{ type, static_cast<int8_t>(a), static_cast<int8_t>(b) };
+	}
+	const Action* begin() const { return moves.data(); }
+	const Action* end() const { return moves.data() + count; }
+};
+
+// Why an action was refused; the console maps each one to its message
+enum class ActionError {
+	None,
+	OutOfRange,		//Cell index not on the board
+	NotAllowed,		//Archetype can't take this action
+	CellOccupied,	//Place/Shift destination taken
+	CellEmpty,		//Swap/Shift source empty
+	TooFewMarks,	//Not enough marks on the board yet
+	SameCell,		//Both cells are the same
+	SameMarks,		//Swap between matching marks
+	NotAdjacent		//Shift destination not next to the source
+};
+
+
+// ------------- Positions -------------
+
+// A board reduced to what the rules care about: two owner masks (seat 0 and
+// seat 1) and the seat to move. Searchers work on these instead of Board.
+struct Position {
+	Mask marks[2] = { 0, 0 };	//Cells held by Player 1 / Player 2
+	int side = 0;				//Player to move
+
+	Mask occupied() const { return static_cast<Mask>(marks[0] | marks[1]); }
+
+	static Position fromBoard(const Board& board, char mark0, char mark1, int side) {
+		Position p;
+		p.marks[0] = board.maskFor(mark0);
+		p.marks[1] = board.maskFor(mark1);
+		p.side = side;
+		return p;
+	}
+};
+
+//Owner of the first completed line in win_lines order (same as Board::winner), -1 for none
+int winnerOf(const Position& p);
+
+void generateActions(const Position& p, Archetype arch, ActionList& out);
+
+Position applyAction(Position p, const Action& m);
+
+//Plays the action on a real board, mark is the mover's (only used for Place)
+void applyAction(Board& board, const Action& m, char mark);
+
+//Winning mark once m has been played on a board nobody had won yet, ' ' for none.
+//A placement only checks the lines through its cell; a swap can complete lines for both marks.
+char winnerAfter(const Board& board, const Action& m);
+
+ActionError validateAction(const Board& board, const Action& m, Archetype arch);
@@ -0,0 +1,226 @@
+#include "SaveFile.h"
+
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+#if defined(_WIN32)
+#include <io.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+
+// ------------- Checksum -------------
+
+namespace {
+
+	constexpr array<uint32_t, 256> makeCrcTable() {
+		array<uint32_t, 256> table{};
+		for (uint32_t i = 0; i < 256; ++i) {
+			uint32_t c = i;
+			for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+			table[i] = c;
+		}
+		return table;
+	}
+
+	constexpr array<uint32_t, 256> crc_table = makeCrcTable();
+
+	Archetype toArchetype(int value) {
+		switch (value) {
+		case 1: return Archetype::Alchemist;
+		case 2: return Archetype::Paladin;
+		default: return Archetype::None;
+		}
+	}
+
+	// Same safety checks the text loader always made
+	void clampSaveData(CampaignSaveData& data) {
+		if (data.hero.maxHP < 1) data.hero.maxHP = 1;
+		if (data.hero.hp < 0) data.hero.hp = 0;
+		if (data.hero.hp > data.hero.maxHP) data.hero.hp = data.hero.maxHP;
+		if (data.stage < 0) data.stage = 0;
+		if (data.legendWandered < 0) data.legendWandered = 0;
+		if (data.legendWilderness < 0) data.legendWilderness = 0;
+	}
+}
+
+uint32_t crc32(const void* data, size_t size, uint32_t crc) {
+	const uint8_t* p = static_cast<const uint8_t*>(data);
+	crc = ~crc;
+	for (size_t i = 0; i < size; ++i) crc = crc_table[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+	return ~crc;
+}
+
+
+// ------------- Record Conversion -------------
+
+SaveRecord makeSaveRecord(const CampaignSaveData& data) {
+	SaveRecord r;
+	r.size = sizeof(SaveRecord);
+	r.archetype = static_cast<uint8_t>(data.hero.archetype);
+	r.mark = data.hero.mark;
+	r.hp = data.hero.hp;
+	r.maxHP = data.hero.maxHP;
+	r.attack = data.hero.attack;
+	r.defense = data.hero.defense;
+	r.stage = data.stage;
+	r.legendWandered = data.legendWandered;
+	r.legendWilderness = data.legendWilderness;
+
+	size_t len = min(data.hero.name.size(), static_cast<size_t>(SaveRecord::nameCapacity));
+	memcpy(r.name, data.hero.name.data(), len);
+	r.nameLength = static_cast<uint8_t>(len);
+
+	if (data.hasRng) {
+		r.rngKey = data.rng.getKey();
+		r.rngCounter = data.rng.getCounter();
+	}
+	r.lastEnemyType = data.lastEnemyType;
+
+	r.checksum = crc32(&r, offsetof(SaveRecord, checksum));
+	return r;
+}
+
+void readSaveRecord(const SaveRecord& r, CampaignSaveData& data) {
+	data.hero.name.assign(r.name, min<size_t>(r.nameLength, SaveRecord::nameCapacity));
+	data.hero.archetype = toArchetype(r.archetype);
+	data.hero.mark = r.mark;
+	data.hero.hp = r.hp;
+	data.hero.maxHP = r.maxHP;
+	data.hero.attack = r.attack;
+	data.hero.defense = r.defense;
+	data.stage = r.stage;
+	data.legendWandered = r.legendWandered;
+	data.legendWilderness = r.legendWilderness;
+
+	data.hasRng = (r.version >= 2 && (r.rngKey | r.rngCounter) != 0);
+	if (data.hasRng) data.rng = Rng::fromState(r.rngKey, r.rngCounter);
+	data.lastEnemyType = (r.version >= 2) ? r.lastEnemyType : -1;
+	clampSaveData(data);
+}
+
+bool isValidSaveRecord(const SaveRecord& r, size_t bytes) {
+	if (r.magic != SaveRecord::magicValue) return false;
+
+	//Version 1 stopped after name, its checksum sits where rngKey is now
+	size_t expected = (r.version == 1) ? SaveRecord::sizeV1 : sizeof(SaveRecord);
+	if (r.version < 1 || r.version > SaveRecord::currentVersion) return false;
+	if (bytes != expected || r.size != expected) return false;
+
+	uint32_t stored;
+	memcpy(&stored, reinterpret_cast<const char*>(&r) + expected - sizeof(stored), sizeof(stored));
+	return stored == crc32(&r, expected - sizeof(stored));
+}
+
+
+// ------------- Writing -------------
+
+bool atomicWriteFile(const string& path, const void* data, size_t size) {
+	string tmp = path + ".tmp";
+
+#if defined(_WIN32)
+	int fd = _open(tmp.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+	if (fd < 0) return false;
+	bool ok = _write(fd, data, static_cast<unsigned>(size)) == static_cast<int>(size) && _commit(fd) == 0;
+	ok = (_close(fd) == 0) && ok;
+	if (!ok || !MoveFileExA(tmp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+		remove(tmp.c_str());
+		return false;
+	}
+#else
+	int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) return false;
+
+	const char* p = static_cast<const char*>(data);
+	size_t left = size;
+	bool ok = true;
+	while (left > 0) {
+		ssize_t n = ::write(fd, p, left);
+		if (n <= 0) {
+			ok = false;
+			break;
+		}
+		p += n;
+		left -= static_cast<size_t>(n);
+	}
+	ok = ok && ::fsync(fd) == 0;
+	ok = (::close(fd) == 0) && ok;
+	if (!ok || ::rename(tmp.c_str(), path.c_str()) != 0) {
+		::unlink(tmp.c_str());
+		return false;
+	}
+
+	//The rename itself lives in the directory, sync that too
+	size_t slash = path.find_last_of('/');
+	string dir = (slash == string::npos) ? "." : path.substr(0, slash + 1);
+	int dirFd = ::open(dir.c_str(), O_RDONLY);
+	if (dirFd >= 0) {
+		::fsync(dirFd);
+		::close(dirFd);
+	}
+#endif
+	return true;
+}
+
+bool writeCampaignSave(const string& path, const CampaignSaveData& data) {
+	SaveRecord record = makeSaveRecord(data);
+	return atomicWriteFile(path, &record, sizeof(record));
+}
+
+
+// ------------- Reading -------------
+
+SaveStatus readCampaignSave(const string& path, CampaignSaveData& data) {
+	ifstream in(path, ios::binary);
+	if (!in) return SaveStatus::Missing;
+
+	SaveRecord record;
+	in.read(reinterpret_cast<char*>(&record), sizeof(record));
+	size_t got = static_cast<size_t>(in.gcount());
+
+	if (got < sizeof(record.magic) || record.magic != SaveRecord::magicValue) {
+		in.close();
+		return readLegacyTextSave(path, data);
+	}
+	if (got >= offsetof(SaveRecord, size) + sizeof(record.size) && record.version > SaveRecord::currentVersion) {
+		return SaveStatus::NewerVersion;
+	}
+	if (in.peek() != char_traits<char>::eof()) return SaveStatus::Corrupt;
+	if (!isValidSaveRecord(record, got)) return SaveStatus::Corrupt;
+
+	readSaveRecord(record, data);
+	return SaveStatus::Ok;
+}
+
+SaveStatus readLegacyTextSave(const string& path, CampaignSaveData& data) {
+	ifstream in(path);
+	if (!in) return SaveStatus::Missing;
+
+	CampaignSaveData loaded;
+	if (!getline(in, loaded.hero.name)) return SaveStatus::Corrupt;
+
+	int archInt = 0;
+	in >> archInt >> loaded.hero.mark;
+	in >> loaded.hero.hp >> loaded.hero.maxHP >> loaded.hero.attack >> loaded.hero.defense;
+	in >> loaded.stage;
+	in >> loaded.legendWandered >> loaded.legendWilderness;
+	if (!in) return SaveStatus::Corrupt;
+
+	loaded.hero.archetype = toArchetype(archInt);
+	clampSaveData(loaded);
+	data = loaded;
+	return SaveStatus::Migrated;
+}
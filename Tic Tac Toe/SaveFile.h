@@ -0,0 +1,90 @@
+#pragma once
+
+#include "Engine.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+
+// ------------- Campaign Save File -------------
+
+// Saves are one fixed-size little-endian record: loading is a single read
+// into the struct plus a CRC check, with nothing to parse. Writes go to a
+// temporary file that is flushed to disk and then renamed over the old save,
+// so a crash leaves either the previous save or the new one, never half of each.
+
+struct CampaignSaveData {
+	Player hero;
+	int stage = 0;
+	int legendWandered = 0;
+	int legendWilderness = 0;
+
+	// -- Version 2 --
+	bool hasRng = false;		//Version 1 saves carry no engine state
+	Rng rng;
+	int lastEnemyType = -1;
+};
+
+struct SaveRecord {
+	static constexpr uint32_t magicValue = 0x53545454;	//"TTTS"
+	static constexpr uint16_t currentVersion = 2;
+	static constexpr size_t sizeV1 = 108;	//Up to name, then the checksum
+	static constexpr int nameCapacity = 64;
+
+	uint32_t magic = magicValue;
+	uint16_t version = currentVersion;
+	uint16_t size = 0;				//sizeof(SaveRecord) when written
+	uint8_t archetype = 0;
+	char mark = 'X';
+	uint8_t nameLength = 0;
+	uint8_t reserved = 0;
+	int32_t hp = 0;
+	int32_t maxHP = 0;
+	int32_t attack = 0;
+	int32_t defense = 0;
+	int32_t stage = 0;
+	int32_t legendWandered = 0;
+	int32_t legendWilderness = 0;
+	char name[nameCapacity] = {};
+
+	// -- Version 2 --
+	uint64_t rngKey = 0;
+	uint64_t rngCounter = 0;
+	int32_t lastEnemyType = -1;
+
+	uint32_t checksum = 0;			//CRC-32 of every byte before it
+};
+
+static_assert(std::is_trivially_copyable_v<SaveRecord>, "SaveRecord is written and read as raw bytes");
+static_assert(sizeof(SaveRecord) == 128 && offsetof(SaveRecord, rngKey) == SaveRecord::sizeV1 - 4,
+	"SaveRecord layout changed, bump currentVersion");
+
+enum class SaveStatus {
+	Ok,
+	Migrated,		//Read from the old text layout
+	Missing,
+	Corrupt,		//Wrong size, magic or checksum
+	NewerVersion	//Written by a newer build
+};
+
+uint32_t crc32(const void* data, size_t size, uint32_t crc = 0);
+
+SaveRecord makeSaveRecord(const CampaignSaveData& data);
+void readSaveRecord(const SaveRecord& record, CampaignSaveData& data);
+
+//Size, version and checksum, for a record of `bytes` bytes (version 1 records are shorter)
+bool isValidSaveRecord(const SaveRecord& record, size_t bytes);
+
+//Temp file + flush to disk + atomic rename, false when any step fails
+bool writeCampaignSave(const std::string& path, const CampaignSaveData& data);
+
+//Binary record, or the old whitespace text layout (returned as Migrated)
+SaveStatus readCampaignSave(const std::string& path, CampaignSaveData& data);
+
+//The text layout campaign_save.txt used before the binary format
+SaveStatus readLegacyTextSave(const std::string& path, CampaignSaveData& data);
+
+//Writes the bytes to path.tmp, syncs them and renames over path
+bool atomicWriteFile(const std::string& path, const void* data, size_t size);
@@ -0,0 +1,414 @@
+#include "SaveStore.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+
+namespace {
+
+	string truncatedName(const string& name) {
+		return name.substr(0, SaveRecord::nameCapacity);
+	}
+
+	bool sameName(const SaveRecord& r, const string& name) {
+		return r.nameLength == name.size() && memcmp(r.name, name.data(), name.size()) == 0;
+	}
+
+	uint32_t roundUpPow2(uint32_t n) {
+		uint32_t p = 16;
+		while (p < n) p <<= 1;
+		return p;
+	}
+
+	size_t fileBytes(uint32_t capacity) {
+		return sizeof(StoreHeader) + static_cast<size_t>(capacity) * sizeof(StoreSlot);
+	}
+
+	bool fileExists(const string& file) {
+		return static_cast<bool>(ifstream(file, ios::binary));
+	}
+
+	uint32_t headerChecksum(const StoreHeader& h) {
+		return crc32(&h, offsetof(StoreHeader, checksum));
+	}
+}
+
+//FNV-1a over the (truncated) name
+uint32_t heroNameHash(const string& name) {
+	uint32_t h = 0x811C9DC5u;
+	for (unsigned char c : name) h = (h ^ c) * 0x01000193u;
+	return h;
+}
+
+
+// ------------- Opening -------------
+
+bool SaveStore::open(const string& file, uint32_t capacity) {
+	lock_guard<std::mutex> lock(mutex);
+	unmap();
+	unlockFile();
+	path = file;
+	error.clear();
+
+	if (!lockFile(path)) return false;
+
+	if (!map(path)) {
+		if (fileExists(path)) {
+			error = path + " can't be read";	//Never overwrite it
+			unlockFile();
+			return false;
+		}
+		if (!createFile(path, roundUpPow2(capacity), {}) || !map(path)) {
+			error = path + " can't be created";
+			unlockFile();
+			return false;
+		}
+	}
+
+	const StoreHeader& h = header();
+	bool valid = mappedSize >= sizeof(StoreHeader)
+		&& h.magic == StoreHeader::magicValue
+		&& h.version == StoreHeader::currentVersion
+		&& h.slotSize == sizeof(StoreSlot)
+		&& h.checksum == headerChecksum(h)
+		&& h.capacity && (h.capacity & (h.capacity - 1)) == 0
+		&& mappedSize == fileBytes(h.capacity);
+	if (!valid) {
+		unmap();	//Leave the file alone, it may still be recoverable
+		unlockFile();
+		error = path + " is not a save store, or is damaged";
+		return false;
+	}
+	return true;
+}
+
+void SaveStore::close() {
+	lock_guard<std::mutex> lock(mutex);
+	unmap();
+	unlockFile();
+}
+
+bool SaveStore::createFile(const string& file, uint32_t slotCount, const vector<StoreSlot>& carry) {
+	vector<char> bytes(fileBytes(slotCount), 0);
+
+	StoreHeader h;
+	h.slotSize = sizeof(StoreSlot);
+	h.capacity = slotCount;
+	h.used = static_cast<uint32_t>(carry.size());
+	h.checksum = headerChecksum(h);
+	memcpy(bytes.data(), &h, sizeof(h));
+
+	StoreSlot* table = reinterpret_cast<StoreSlot*>(bytes.data() + sizeof(StoreHeader));	//All zero = Empty
+
+	for (const StoreSlot& s : carry) {
+		uint32_t i = s.nameHash & (slotCount - 1);
+		while (table[i].state != StoreSlot::Empty) i = (i + 1) & (slotCount - 1);
+		table[i] = s;
+	}
+
+	//Whole file at once, so a crash mid-grow keeps the old table
+	return atomicWriteFile(file, bytes.data(), bytes.size());
+}
+
+bool SaveStore::grow() {
+	vector<StoreSlot> carry;
+	carry.reserve(header().used);
+	for (uint32_t i = 0; i < header().capacity; ++i) {
+		if (slots()[i].state == StoreSlot::Used) carry.push_back(slots()[i]);
+	}
+
+	uint32_t bigger = header().capacity * 2;
+	unmap();
+	bool ok = createFile(path, bigger, carry);
+	return map(path) && ok;
+}
+
+
+// ------------- Slots -------------
+
+int SaveStore::findSlot(const string& name, uint32_t hash, int* insertAt) const {
+	uint32_t mask = header().capacity - 1;
+	if (insertAt) *insertAt = -1;
+
+	for (uint32_t probe = 0, i = hash & mask; probe <= mask; ++probe, i = (i + 1) & mask) {
+		const StoreSlot& s = slots()[i];
+		if (s.state == StoreSlot::Empty) {
+			if (insertAt && *insertAt < 0) *insertAt = static_cast<int>(i);
+			return -1;
+		}
+		if (s.state == StoreSlot::Removed) {
+			if (insertAt && *insertAt < 0) *insertAt = static_cast<int>(i);
+			continue;
+		}
+		if (s.nameHash == hash && sameName(s.record, name)) return static_cast<int>(i);
+	}
+	return -1;
+}
+
+bool SaveStore::store(const CampaignSaveData& data) {
+	lock_guard<std::mutex> lock(mutex);
+	if (!isOpen()) return false;
+
+	string name = truncatedName(data.hero.name);
+	uint32_t hash = heroNameHash(name);
+	int insertAt = -1;
+	int idx = findSlot(name, hash, &insertAt);
+
+	if (idx < 0) {
+		const StoreHeader& h = header();
+		if ((h.used + h.tombstones + 1) * 4 > h.capacity * 3) {
+			if (!grow()) return false;
+			findSlot(name, hash, &insertAt);
+		}
+		if (insertAt < 0) return false;
+
+		idx = insertAt;
+		StoreHeader& hw = header();
+		if (slots()[idx].state == StoreSlot::Removed) hw.tombstones--;
+		hw.used++;
+	}
+
+	StoreSlot& slot = slots()[idx];
+	slot.record = makeSaveRecord(data);
+	slot.nameHash = hash;
+	slot.state = StoreSlot::Used;
+	writeHeader();
+
+	flushRange(&slot, sizeof(slot));
+	return true;
+}
+
+SaveStatus SaveStore::load(const string& heroName, CampaignSaveData& data) const {
+	lock_guard<std::mutex> lock(mutex);
+	if (!isOpen()) return SaveStatus::Missing;
+
+	string name = truncatedName(heroName);
+	int idx = findSlot(name, heroNameHash(name), nullptr);
+	if (idx < 0) return SaveStatus::Missing;
+
+	const SaveRecord& r = slots()[idx].record;
+	if (!isValidSaveRecord(r, sizeof(SaveRecord))) return SaveStatus::Corrupt;
+
+	readSaveRecord(r, data);
+	return SaveStatus::Ok;
+}
+
+bool SaveStore::contains(const string& heroName) const {
+	lock_guard<std::mutex> lock(mutex);
+	if (!isOpen()) return false;
+
+	string name = truncatedName(heroName);
+	return findSlot(name, heroNameHash(name), nullptr) >= 0;
+}
+
+bool SaveStore::remove(const string& heroName) {
+	lock_guard<std::mutex> lock(mutex);
+	if (!isOpen()) return false;
+
+	string name = truncatedName(heroName);
+	int idx = findSlot(name, heroNameHash(name), nullptr);
+	if (idx < 0) return false;
+
+	StoreSlot& slot = slots()[idx];
+	slot.state = StoreSlot::Removed;
+	header().used--;
+	header().tombstones++;
+	writeHeader();
+
+	flushRange(&slot, sizeof(slot));
+	return true;
+}
+
+vector<string> SaveStore::list() const {
+	lock_guard<std::mutex> lock(mutex);
+	vector<string> names;
+	if (!isOpen()) return names;
+
+	names.reserve(header().used);
+	for (uint32_t i = 0; i < header().capacity; ++i) {
+		const StoreSlot& s = slots()[i];
+		if (s.state == StoreSlot::Used) names.emplace_back(s.record.name, min<size_t>(s.record.nameLength, SaveRecord::nameCapacity));
+	}
+	return names;
+}
+
+uint32_t SaveStore::size() const {
+	lock_guard<std::mutex> lock(mutex);
+	return isOpen() ? header().used : 0;
+}
+
+uint32_t SaveStore::capacity() const {
+	lock_guard<std::mutex> lock(mutex);
+	return isOpen() ? header().capacity : 0;
+}
+
+void SaveStore::writeHeader() {
+	header().checksum = headerChecksum(header());
+	flushRange(base, sizeof(StoreHeader));
+}
+
+
+// ------------- Mapping -------------
+
+#if defined(_WIN32)
+
+bool SaveStore::map(const string& file) {
+	HANDLE f = CreateFileA(file.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (f == INVALID_HANDLE_VALUE) return false;
+
+	LARGE_INTEGER bytes;
+	if (!GetFileSizeEx(f, &bytes) || bytes.QuadPart < static_cast<LONGLONG>(sizeof(StoreHeader))) {
+		CloseHandle(f);
+		return false;
+	}
+
+	HANDLE m = CreateFileMappingA(f, nullptr, PAGE_READWRITE, 0, 0, nullptr);
+	void* view = m ? MapViewOfFile(m, FILE_MAP_ALL_ACCESS, 0, 0, 0) : nullptr;
+	if (!view) {
+		if (m) CloseHandle(m);
+		CloseHandle(f);
+		return false;
+	}
+
+	fileHandle = f;
+	mappingHandle = m;
+	base = static_cast<char*>(view);
+	mappedSize = static_cast<size_t>(bytes.QuadPart);
+	return true;
+}
+
+void SaveStore::unmap() {
+	if (!base) return;
+	FlushViewOfFile(base, 0);
+	UnmapViewOfFile(base);
+	CloseHandle(mappingHandle);
+	CloseHandle(fileHandle);
+	base = nullptr;
+	mappedSize = 0;
+	fileHandle = mappingHandle = nullptr;
+}
+
+void SaveStore::flushRange(const void* at, size_t bytes) {
+	FlushViewOfFile(at, bytes);	//Queues the write, FlushFileBuffers in sync() waits for it
+}
+
+bool SaveStore::lockFile(const string& file) {
+	string lockPath = file + ".lock";
+	HANDLE h = CreateFileA(lockPath.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+		OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (h == INVALID_HANDLE_VALUE) {
+		error = "can't create " + lockPath;
+		return false;
+	}
+
+	OVERLAPPED at = {};
+	if (!LockFileEx(h, LOCKFILE_EXCLUSIVE_LOCK | LOCKFILE_FAIL_IMMEDIATELY, 0, 1, 0, &at)) {
+		CloseHandle(h);
+		error = file + " is already open elsewhere";
+		return false;
+	}
+	lockHandle = h;
+	return true;
+}
+
+void SaveStore::unlockFile() {
+	if (!lockHandle) return;
+	CloseHandle(lockHandle);	//Releases the lock; the file stays for the next owner
+	lockHandle = nullptr;
+}
+
+bool SaveStore::sync() {
+	lock_guard<std::mutex> lock(mutex);
+	if (!isOpen()) return false;
+	return FlushViewOfFile(base, 0) && FlushFileBuffers(fileHandle);
+}
+
+#else
+
+bool SaveStore::map(const string& file) {
+	int f = ::open(file.c_str(), O_RDWR);
+	if (f < 0) return false;
+
+	struct stat st;
+	if (fstat(f, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(StoreHeader))) {
+		::close(f);
+		return false;
+	}
+
+	void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ | PROT_WRITE, MAP_SHARED, f, 0);
+	if (view == MAP_FAILED) {
+		::close(f);
+		return false;
+	}
+
+	fd = f;
+	base = static_cast<char*>(view);
+	mappedSize = static_cast<size_t>(st.st_size);
+	return true;
+}
+
+void SaveStore::unmap() {
+	if (!base) return;
+	msync(base, mappedSize, MS_SYNC);
+	munmap(base, mappedSize);
+	::close(fd);
+	base = nullptr;
+	mappedSize = 0;
+	fd = -1;
+}
+
+void SaveStore::flushRange(const void* at, size_t bytes) {
+	static const uintptr_t page = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+	uintptr_t start = reinterpret_cast<uintptr_t>(at) & ~(page - 1);
+	uintptr_t end = reinterpret_cast<uintptr_t>(at) + bytes;
+	msync(reinterpret_cast<void*>(start), end - start, MS_ASYNC);	//Schedules writeback, sync() waits
+}
+
+bool SaveStore::lockFile(const string& file) {
+	string lockPath = file + ".lock";
+	int f = ::open(lockPath.c_str(), O_RDWR | O_CREAT, 0644);
+	if (f < 0) {
+		error = "can't create " + lockPath;
+		return false;
+	}
+
+	if (flock(f, LOCK_EX | LOCK_NB) != 0) {
+		bool held = (errno == EWOULDBLOCK);
+		::close(f);
+		error = held ? file + " is already open elsewhere" : "can't lock " + lockPath;
+		return false;
+	}
+	lockFd = f;
+	return true;
+}
+
+void SaveStore::unlockFile() {
+	if (lockFd < 0) return;
+	::close(lockFd);	//Releases the lock; the file stays for the next owner
+	lockFd = -1;
+}
+
+bool SaveStore::sync() {
+	lock_guard<std::mutex> lock(mutex);
+	if (!isOpen()) return false;
+	return msync(base, mappedSize, MS_SYNC) == 0 && fsync(fd) == 0;
+}
+
+#endif
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "SaveFile.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+// ------------- Multi-Slot Save Store -------------
+
+// Thousands of campaigns in one memory-mapped file. The slots form an open
+// addressing hash table keyed by hero name, so finding, loading and
+// checkpointing a hero touch one or two slots and no per-player files.
+// Each slot holds a full SaveRecord with its own checksum; a write torn by a
+// crash only loses that hero's latest checkpoint. The table grows (rehash into
+// a new file + atomic rename) once it is three quarters full.
+// One process owns a store at a time: open() takes an exclusive lock on a
+// "<path>.lock" file beside it (kept across grows, which replace the store
+// file) and fails if another process holds it. The methods are safe across
+// the owning process's threads.
+
+struct StoreHeader {
+	static constexpr uint32_t magicValue = 0x4D545454;	//"TTTM"
+	static constexpr uint16_t currentVersion = 1;
+
+	uint32_t magic = magicValue;
+	uint16_t version = currentVersion;
+	uint16_t slotSize = 0;
+	uint32_t capacity = 0;		//Slots, a power of two
+	uint32_t used = 0;
+	uint32_t tombstones = 0;	//Removed slots still breaking probe chains
+	uint32_t checksum = 0;		//CRC-32 of the fields above
+	uint8_t reserved[40] = {};
+};
+
+struct StoreSlot {
+	enum : uint8_t { Empty, Used, Removed };
+
+	uint8_t state = Empty;
+	uint8_t reserved[3] = {};
+	uint32_t nameHash = 0;
+	SaveRecord record;
+};
+
+static_assert(sizeof(StoreHeader) == 64, "StoreHeader layout changed, bump its version");
+static_assert(sizeof(StoreSlot) == 136, "StoreSlot layout changed, bump the store version");
+
+class SaveStore {
+public:
+	static constexpr uint32_t defaultCapacity = 4096;
+
+	SaveStore() = default;
+	~SaveStore() { close(); }
+
+	SaveStore(const SaveStore&) = delete;
+	SaveStore& operator=(const SaveStore&) = delete;
+
+	//Opens or creates the file; capacity only applies to a new store. lastError() says why it failed.
+	bool open(const std::string& path, uint32_t capacity = defaultCapacity);
+	void close();
+	bool isOpen() const { return base != nullptr; }
+	const std::string& lastError() const { return error; }
+
+	//Insert or overwrite the hero's slot, then schedule it for writeback
+	bool store(const CampaignSaveData& data);
+	SaveStatus load(const std::string& heroName, CampaignSaveData& data) const;
+	bool contains(const std::string& heroName) const;
+	bool remove(const std::string& heroName);
+
+	//Names of every saved hero, in slot order
+	std::vector<std::string> list() const;
+
+	uint32_t size() const;
+	uint32_t capacity() const;
+
+	//Blocks until every slot written so far is on disk
+	bool sync();
+
+private:
+	std::string path;
+	std::string error;
+	mutable std::mutex mutex;
+
+	char* base = nullptr;
+	size_t mappedSize = 0;
+#if defined(_WIN32)
+	void* fileHandle = nullptr;
+	void* mappingHandle = nullptr;
+	void* lockHandle = nullptr;
+#else
+	int fd = -1;
+	int lockFd = -1;
+#endif
+
+	StoreHeader& header() const { return *reinterpret_cast<StoreHeader*>(base); }
+	StoreSlot* slots() const { return reinterpret_cast<StoreSlot*>(base + sizeof(StoreHeader)); }
+
+	bool map(const std::string& file);
+	void unmap();
+	bool lockFile(const std::string& file);	//False if another process holds the store
+	void unlockFile();
+	bool createFile(const std::string& file, uint32_t capacity, const std::vector<StoreSlot>& carry);
+	bool grow();
+
+	//Slot holding the name, or -1; insertAt gets the first free slot on the way
+	int findSlot(const std::string& name, uint32_t hash, int* insertAt) const;
+	void writeHeader();
+	void flushRange(const void* at, size_t bytes);
+};
+
+uint32_t heroNameHash(const std::string& name);
@@ -0,0 +1,280 @@
+#include "SelfPlay.h"
+#include "Console.h"
+#include "Mcts.h"
+#include "Replay.h"
+#include "Rng.h"
+#include "Simulator.h"
+#include "ThreadPool.h"
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+
+namespace {
+
+	// Hashes every action as it is played
+	class DigestListener : public MatchListener {
+	public:
+		uint64_t digest = fnvOffset;
+
+		void onAction(const Board&, const Player&, int seat, const Action& action) override {
+			digest = fnvFold(digest, (static_cast<uint64_t>(seat) << 24) | (static_cast<uint64_t>(action.type) << 16)
+				| (static_cast<uint64_t>(static_cast<uint8_t>(action.a)) << 8) | static_cast<uint8_t>(action.b));
+		}
+	};
+
+	//Campaign boards are played by enemy strategies; Search plays as Random there
+	EnemyStrategy campaignStrategy(BotKind kind) {
+		switch (kind) {
+		case BotKind::Perfect: return EnemyStrategy::Perfect;
+		case BotKind::Greedy:  return EnemyStrategy::Greedy;
+		case BotKind::Mcts:    return EnemyStrategy::Mcts;
+		default:               return EnemyStrategy::Random;
+		}
+	}
+
+	GameRecord playCampaign(const SelfPlayConfig& config, int index) {
+		SimulationConfig sim;
+		sim.seed = config.seed;
+		sim.policy.boardPlay = campaignStrategy(config.bots[0]);
+		sim.enemy = campaignStrategy(config.bots[1]);
+
+		ReplayWriter writer;
+		CampaignSummary s = simulateCampaign(config.archetypes[0], sim, index, config.recordPath.empty() ? nullptr : &writer);
+
+		GameRecord record;
+		//The hero is seat 0; a quit (round-limit stalemates end as one) is nobody's win
+		record.outcome.winnerSeat = (s.result == CampaignResult::Victory) ? 0 : (s.result == CampaignResult::Defeat) ? 1 : -1;
+		record.outcome.turns = s.roundsPlayed;
+		record.digest = fnvFold(fnvFold(fnvFold(fnvOffset, static_cast<uint64_t>(s.result)), static_cast<uint64_t>(s.endStage)),
+			(static_cast<uint64_t>(s.heroHP) << 32) | static_cast<uint32_t>(s.roundsPlayed));
+		record.replay = writer.data();
+		return record;
+	}
+
+	const char* modeName(SelfPlayMode m) {
+		switch (m) {
+		case SelfPlayMode::Battle:   return "battle";
+		case SelfPlayMode::Campaign: return "campaign";
+		default:                     return "regular";
+		}
+	}
+}
+
+
+// ------------- Bots -------------
+
+const char* botName(BotKind kind) {
+	switch (kind) {
+	case BotKind::Perfect: return "perfect";
+	case BotKind::Search:  return "search";
+	case BotKind::Greedy:  return "greedy";
+	case BotKind::Mcts:    return "mcts";
+	default:               return "random";
+	}
+}
+
+bool parseBotKind(const string& name, BotKind& kind) {
+	for (BotKind k : { BotKind::Random, BotKind::Perfect, BotKind::Search, BotKind::Greedy, BotKind::Mcts }) {
+		if (name == botName(k)) {
+			kind = k;
+			return true;
+		}
+	}
+	return false;
+}
+
+unique_ptr<PlayerController> makeBot(BotKind kind, Rng& rng, int depth) {
+	switch (kind) {
+	case BotKind::Perfect:
+	case BotKind::Greedy: {
+		auto bot = make_unique<StrategyController>(kind == BotKind::Perfect ? EnemyStrategy::Perfect : EnemyStrategy::Greedy);
+		bot->rng = &rng;
+		return bot;
+	}
+	case BotKind::Search:
+		return make_unique<BattleAIController>(depth);
+	case BotKind::Mcts: {
+		MctsConfig config;
+		config.iterations = 2000;
+		auto bot = make_unique<MctsController>(config);
+		bot->rng = &rng;
+		return bot;
+	}
+	case BotKind::Random:
+	default: {
+		auto bot = make_unique<RandomController>();
+		bot->rng = &rng;
+		return bot;
+	}
+	}
+}
+
+
+// ------------- Self-Play Runner -------------
+
+GameRecord playSelfPlayGame(const SelfPlayConfig& config, int index) {
+	if (config.mode == SelfPlayMode::Campaign) {
+		return playCampaign(config, index);
+	}
+
+	Rng rngs[2] = { Rng(config.seed, 2 * static_cast<uint64_t>(index)), Rng(config.seed, 2 * static_cast<uint64_t>(index) + 1) };
+	unique_ptr<PlayerController> bots[2] = {
+		makeBot(config.bots[0], rngs[0], config.searchDepth),
+		makeBot(config.bots[1], rngs[1], config.searchDepth)
+	};
+
+	bool battle = (config.mode == SelfPlayMode::Battle);
+	Player players[2];
+	players[0].name = "Player 1";
+	players[0].mark = 'X';
+	players[1].name = "Player 2";
+	players[1].mark = 'O';
+	for (int seat = 0; seat < 2; ++seat) {
+		players[seat].archetype = battle ? config.archetypes[seat] : Archetype::None;
+	}
+
+	DigestListener digest;
+	ReplayWriter writer;
+	TicTacToeGame game;
+	game.setPlayer(0, players[0], *bots[0]);
+	game.setPlayer(1, players[1], *bots[1]);
+	game.setBattleRules(battle);
+	game.setTurnLimit(battle ? config.turnLimit : 0);
+	game.setListener(&digest);
+	if (!config.recordPath.empty()) game.setReplay(&writer);
+
+	GameRecord record;
+	record.outcome = game.run();
+	record.digest = digest.digest;
+	record.replay = writer.data();
+	return record;
+}
+
+SelfPlayReport runSelfPlay(const SelfPlayConfig& config) {
+	SelfPlayReport report;
+	report.config = config;
+
+	ThreadPool pool(config.threads);
+	report.threadsUsed = pool.size();
+
+	vector<GameRecord> records(config.games);
+	auto start = chrono::steady_clock::now();
+
+	pool.parallelFor(config.games, [&](int i) {
+		records[i] = playSelfPlayGame(config, i);
+	});
+
+	report.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+	report.digest = fnvOffset;
+	for (const GameRecord& r : records) {
+		if (r.outcome.winnerSeat == -1) report.ties++;
+		else report.wins[r.outcome.winnerSeat]++;
+		if (r.outcome.turnLimitHit) report.turnLimitHits++;
+		report.turns += r.outcome.turns;
+		report.digest = fnvFold(report.digest, r.digest);
+	}
+
+	//Index order, so the corpus is the same for any thread count
+	if (!config.recordPath.empty()) {
+		ofstream file(config.recordPath, ios::binary | ios::app);
+		for (const GameRecord& r : records) file.write(r.replay.data(), static_cast<streamsize>(r.replay.size()));
+		report.recorded = static_cast<bool>(file);
+	}
+	return report;
+}
+
+void printSelfPlayReport(ostream& out, const SelfPlayReport& report) {
+	const SelfPlayConfig& c = report.config;
+	auto pct = [&](int n) { return c.games > 0 ? 100.0 * n / c.games : 0.0; };
+
+	out << "Self-play: " << c.games << " " << modeName(c.mode) << " games, " << botName(c.bots[0]) << " vs " << botName(c.bots[1])
+		<< ", seed " << c.seed << ", " << report.threadsUsed << " threads\n";
+	out << fixed << setprecision(2) << "  " << report.seconds << "s, "
+		<< setprecision(0) << (report.seconds > 0 ? c.games / report.seconds : 0.0) << " games/s\n";
+	out << setprecision(1);
+	out << "  Seat 1 wins " << pct(report.wins[0]) << "%, Seat 2 wins " << pct(report.wins[1]) << "%, Ties " << pct(report.ties) << "%";
+	if (report.turnLimitHits) out << " (" << report.turnLimitHits << " hit the turn limit)";
+	out << "\n  Average length " << (c.games ? static_cast<double>(report.turns) / c.games : 0.0)
+		<< (c.mode == SelfPlayMode::Campaign ? " rounds\n" : " turns\n");
+	if (!c.recordPath.empty()) out << "  " << (report.recorded ? "Recorded to " : "Could not record to ") << c.recordPath << "\n";
+	out << "  Digest " << hex << setw(16) << setfill('0') << report.digest << dec << setfill(' ') << "\n";
+}
+
+int runSelfPlayCommand(int argc, char* argv[]) {
+	SelfPlayConfig config;
+
+	//False for an unknown name, so a typo is reported instead of playing Random
+	auto parseArch = [](const string& v, Archetype& arch) {
+		if (v == "alchemist") arch = Archetype::Alchemist;
+		else if (v == "paladin") arch = Archetype::Paladin;
+		else return false;
+		return true;
+	};
+	auto parseMode = [](const string& v, SelfPlayMode& mode) {
+		if (v == "regular") mode = SelfPlayMode::Regular;
+		else if (v == "battle") mode = SelfPlayMode::Battle;
+		else if (v == "campaign") mode = SelfPlayMode::Campaign;
+		else return false;
+		return true;
+	};
+	auto usage = [](const string& problem) {
+		cerr << problem << "\n"
+			<< "Usage: --selfplay [games] [--mode regular|battle|campaign] [--p1 random|perfect|search|greedy|mcts] [--p2 ...]\n"
+			<< "       [--arch1 alchemist|paladin] [--arch2 ...] [--seed N] [--threads N] [--turn-limit N] [--depth N]\n"
+			<< "       [--record <file>]\n";
+		return 1;
+	};
+
+	for (int i = 0; i < argc; ++i) {
+		string arg = argv[i];
+		string value = (i + 1 < argc) ? argv[i + 1] : "";
+
+		if (arg == "--mode" && !value.empty()) {
+			if (!parseMode(value, config.mode)) return usage("Unknown mode: " + value);
+			++i;
+		}
+		else if (arg == "--seed" && !value.empty()) {
+			if (!parseUint64(value, config.seed)) return usage("Invalid seed: " + value);
+			++i;
+		}
+		else if (arg == "--threads" && !value.empty()) {
+			if (!parseInt(value, config.threads, 0)) return usage("Invalid thread count: " + value);
+			++i;
+		}
+		else if (arg == "--turn-limit" && !value.empty()) {
+			if (!parseInt(value, config.turnLimit, 0)) return usage("Invalid turn limit: " + value);
+			++i;
+		}
+		else if (arg == "--depth" && !value.empty()) {
+			if (!parseInt(value, config.searchDepth, 1, 64)) return usage("Invalid depth: " + value);
+			++i;
+		}
+		else if (arg == "--record" && !value.empty()) { config.recordPath = value; ++i; }
+		else if ((arg == "--p1" || arg == "--p2") && !value.empty()) {
+			if (!parseBotKind(value, config.bots[arg == "--p2"])) return usage("Unknown bot: " + value);
+			++i;
+		}
+		else if ((arg == "--arch1" || arg == "--arch2") && !value.empty()) {
+			if (!parseArch(value, config.archetypes[arg == "--arch2"])) return usage("Unknown archetype: " + value);
+			++i;
+		}
+		else if (!arg.empty() && isdigit(static_cast<unsigned char>(arg[0]))) {
+			if (!parseInt(arg, config.games, 1)) return usage("Invalid game count: " + arg);
+		}
+		else {
+			return usage("Unknown option: " + arg);
+		}
+	}
+
+	printSelfPlayReport(cout, runSelfPlay(config));
+	return 0;
+}
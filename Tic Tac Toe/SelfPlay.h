@@ -0,0 +1,70 @@
+#pragma once
+
+#include "Engine.h"
+
+#include <memory>
+#include <ostream>
+#include <string>
+
+
+// ------------- Self-Play Runner -------------
+
+// Runs many headless games at once on the work-stealing pool. Game i draws
+// only from Rng streams derived from (seed, i) and owns its controllers, so
+// the per-game results and the run digest are identical for any thread count.
+
+enum class SelfPlayMode { Regular, Battle, Campaign };
+
+enum class BotKind {
+	Random,		//Uniform over legal actions
+	Perfect,	//Solver lookup (places only)
+	Search,		//Alpha-beta Battle search
+	Greedy,		//Wins or blocks when it can, else random (places only)
+	Mcts		//Monte Carlo tree search, single-threaded with a fixed iteration budget
+};
+
+const char* botName(BotKind kind);
+
+//"random", "perfect", "search", "greedy" or "mcts"; false for anything else
+bool parseBotKind(const std::string& name, BotKind& kind);
+
+//A fresh controller drawing only from rng; depth is for Search
+//(games already run in parallel, so Mcts bots search on one thread)
+std::unique_ptr<PlayerController> makeBot(BotKind kind, Rng& rng, int depth);
+
+struct SelfPlayConfig {
+	SelfPlayMode mode = SelfPlayMode::Regular;
+	int games = 100000;
+	uint64_t seed = 1;
+	int threads = 0;	//0 = one per core
+	BotKind bots[2] = { BotKind::Random, BotKind::Random };
+	Archetype archetypes[2] = { Archetype::Alchemist, Archetype::Paladin };	//Battle and Campaign (seat 0 is the hero)
+	int turnLimit = 200;	//Battle games past this are Ties
+	int searchDepth = 6;
+	std::string recordPath;	//Appends every game's replay log in index order when set
+};
+
+struct GameRecord {
+	GameOutcome outcome;
+	uint64_t digest = 0;	//FNV-1a over every action played
+	std::string replay;		//Encoded log, only when recording
+};
+
+struct SelfPlayReport {
+	SelfPlayConfig config;
+	int wins[2] = { 0, 0 };
+	int ties = 0;
+	int turnLimitHits = 0;
+	long long turns = 0;
+	uint64_t digest = 0;	//All game digests folded in index order
+	bool recorded = false;
+	int threadsUsed = 0;
+	double seconds = 0.0;
+};
+
+GameRecord playSelfPlayGame(const SelfPlayConfig& config, int index);
+SelfPlayReport runSelfPlay(const SelfPlayConfig& config);
+void printSelfPlayReport(std::ostream& out, const SelfPlayReport& report);
+
+//Entry point for "--selfplay [games] [options]"
+int runSelfPlayCommand(int argc, char* argv[]);
@@ -0,0 +1,895 @@
+#include "Server.h"
+#include "Console.h"
+#include "Rng.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <thread>
+
+#if defined(__linux__)
+#include <arpa/inet.h>
+#include <csignal>
+#include <cerrno>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+
+// ------------- Wire Format -------------
+
+string formatWireAction(const Action& action) {
+	switch (action.type) {
+	case ActionType::Swap:	return "SWAP " + to_string(action.a + 1) + " " + to_string(action.b + 1);
+	case ActionType::Shift:	return "SHIFT " + to_string(action.a + 1) + " " + to_string(action.b + 1);
+	case ActionType::Place:
+	default:				return "PLACE " + to_string(action.a + 1);
+	}
+}
+
+bool parseWireAction(const string& line, Action& action) {
+	istringstream in(line);
+	string word;
+	int a = 0, b = 0;
+	if (!(in >> word >> a)) return false;
+
+	//Out-of-range cells still parse, so the rules can answer out_of_range
+	auto cell = [](int n) { return 1 <= n && n <= 99; };
+	if (word == "PLACE") {
+		if (!cell(a)) return false;
+		action = Action::place(a - 1);
+	}
+	else if (word == "SWAP" || word == "SHIFT") {
+		if (!(in >> b) || !cell(a) || !cell(b)) return false;
+		action = (word == "SWAP") ? Action::swap(a - 1, b - 1) : Action::shift(a - 1, b - 1);
+	}
+	else {
+		return false;
+	}
+
+	in >> ws;
+	return in.eof();
+}
+
+const char* actionErrorName(ActionError error) {
+	switch (error) {
+	case ActionError::None:			return "ok";
+	case ActionError::OutOfRange:	return "out_of_range";
+	case ActionError::NotAllowed:	return "not_allowed";
+	case ActionError::CellOccupied:	return "cell_occupied";
+	case ActionError::CellEmpty:	return "cell_empty";
+	case ActionError::TooFewMarks:	return "too_few_marks";
+	case ActionError::SameCell:		return "same_cell";
+	case ActionError::SameMarks:	return "same_marks";
+	case ActionError::NotAdjacent:	return "not_adjacent";
+	}
+	return "not_allowed";
+}
+
+namespace {
+	const char seatMarks[2] = { 'X', 'O' };
+
+	string boardText(const Board& board) {
+		string s(Board::cells, '.');
+		for (int i = 0; i < Board::cells; ++i) {
+			if (board.get(i) != ' ') s[i] = board.get(i);
+		}
+		return s;
+	}
+
+	//First word and the rest of the line
+	pair<string, string> splitCommand(const string& line) {
+		size_t space = line.find(' ');
+		if (space == string::npos) return { line, "" };
+		return { line.substr(0, space), line.substr(space + 1) };
+	}
+}
+
+
+#if defined(__linux__)
+
+// ------------- Match Server -------------
+
+GameServer::~GameServer() {
+	closeAll();
+	if (wakeFd >= 0) ::close(wakeFd);
+}
+
+bool GameServer::start(string& error) {
+	auto fail = [&](const string& what) {
+		error = what + ": " + strerror(errno);
+		closeAll();
+		return false;
+	};
+
+	if (!config.unixPath.empty()) {
+		listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+		if (listenFd < 0) return fail("socket");
+
+		sockaddr_un addr{};
+		addr.sun_family = AF_UNIX;
+		if (config.unixPath.size() >= sizeof(addr.sun_path)) {
+			error = "Unix socket path too long";
+			closeAll();
+			return false;
+		}
+		copy(config.unixPath.begin(), config.unixPath.end(), addr.sun_path);
+		::unlink(config.unixPath.c_str());	//Left over from a previous run
+		if (::bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) return fail("bind " + config.unixPath);
+	}
+	else {
+		listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+		if (listenFd < 0) return fail("socket");
+
+		int on = 1;
+		setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+		sockaddr_in addr{};
+		addr.sin_family = AF_INET;
+		addr.sin_port = htons(static_cast<uint16_t>(config.port));
+		if (inet_pton(AF_INET, config.bindAddress.c_str(), &addr.sin_addr) != 1) {
+			error = "Bad bind address " + config.bindAddress;
+			closeAll();
+			return false;
+		}
+		if (::bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) return fail("bind port " + to_string(config.port));
+
+		socklen_t len = sizeof(addr);
+		getsockname(listenFd, reinterpret_cast<sockaddr*>(&addr), &len);
+		boundPort = ntohs(addr.sin_port);
+	}
+
+	if (::listen(listenFd, SOMAXCONN) < 0) return fail("listen");
+
+	epollFd = epoll_create1(EPOLL_CLOEXEC);
+	if (epollFd < 0) return fail("epoll_create1");
+	if (wakeFd < 0) wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (wakeFd < 0) return fail("eventfd");
+
+	epoll_event ev{};
+	ev.events = EPOLLIN;
+	ev.data.u64 = 0;
+	epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &ev);
+	ev.data.u64 = 1;
+	epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &ev);
+	return true;
+}
+
+void GameServer::run() {
+	epoll_event events[64];
+	while (!stopping.load() && epollFd >= 0) {
+		int n = epoll_wait(epollFd, events, 64, -1);
+		if (n < 0) {
+			if (errno == EINTR) continue;
+			break;
+		}
+
+		for (int i = 0; i < n; ++i) {
+			uint64_t id = events[i].data.u64;
+			if (id == 0) {
+				acceptAll();
+				continue;
+			}
+			if (id == 1) {
+				uint64_t count;
+				while (::read(wakeFd, &count, sizeof(count)) > 0) {}
+				continue;
+			}
+
+			auto it = conns.find(id);
+			if (it == conns.end() || it->second.fd < 0) continue;
+			uint32_t flags = events[i].events;
+			if (flags & (EPOLLIN | EPOLLHUP | EPOLLERR)) readFrom(id);
+			if (flags & EPOLLOUT) dirty.push_back(id);
+		}
+
+		//Replies go out once per pass, however many lines produced them
+		for (size_t i = 0; i < dirty.size(); ++i) flush(dirty[i]);
+		dirty.clear();
+		for (uint64_t id : closed) conns.erase(id);
+		closed.clear();
+	}
+	closeAll();
+}
+
+void GameServer::stop() {
+	stopping.store(true);
+	if (wakeFd >= 0) {
+		uint64_t one = 1;
+		ssize_t ignored = ::write(wakeFd, &one, sizeof(one));
+		(void)ignored;
+	}
+}
+
+void GameServer::acceptAll() {
+	while (true) {
+		int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+		if (fd < 0) return;	//EAGAIN: nothing left to accept
+
+		if (config.unixPath.empty()) {
+			int on = 1;
+			setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));	//One short line per move
+		}
+
+		uint64_t id = nextId++;
+		Connection& c = conns[id];
+		c.fd = fd;
+		c.name = "player" + to_string(id - 1);
+
+		epoll_event ev{};
+		ev.events = EPOLLIN;
+		ev.data.u64 = id;
+		epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev);
+
+		++counters.connections;
+		send(id, "HELLO tictactoe 1");
+	}
+}
+
+void GameServer::readFrom(uint64_t id) {
+	Connection& c = conns[id];
+	char buffer[4096];
+	bool eof = false;
+	while (true) {
+		ssize_t got = recv(c.fd, buffer, sizeof(buffer), 0);
+		if (got > 0) {
+			c.in.append(buffer, static_cast<size_t>(got));
+			continue;
+		}
+		if (got < 0 && errno == EINTR) continue;
+		eof = (got == 0) || (errno != EAGAIN && errno != EWOULDBLOCK);
+		break;
+	}
+
+	size_t start = 0, end;
+	while (!c.closing && c.fd >= 0 && (end = c.in.find('\n', start)) != string::npos) {
+		string line = c.in.substr(start, end - start);
+		if (!line.empty() && line.back() == '\r') line.pop_back();
+		start = end + 1;
+		handleLine(id, line);
+	}
+	c.in.erase(0, start);
+
+	if (eof || c.in.size() > config.maxLineLength) drop(id);
+}
+
+void GameServer::flush(uint64_t id) {
+	auto it = conns.find(id);
+	if (it == conns.end() || it->second.fd < 0) return;
+	Connection& c = it->second;
+
+	size_t sent = 0;
+	while (sent < c.out.size()) {
+		ssize_t n = ::send(c.fd, c.out.data() + sent, c.out.size() - sent, MSG_NOSIGNAL);
+		if (n > 0) {
+			sent += static_cast<size_t>(n);
+			continue;
+		}
+		if (n < 0 && errno == EINTR) continue;
+		if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+		drop(id);
+		return;
+	}
+	c.out.erase(0, sent);
+
+	if (c.out.empty() && c.closing) {
+		drop(id);
+		return;
+	}
+
+	//Only ask for EPOLLOUT while something is left to write
+	bool want = !c.out.empty();
+	if (want != c.wantWrite) {
+		epoll_event ev{};
+		ev.events = EPOLLIN | (want ? EPOLLOUT : 0u);
+		ev.data.u64 = id;
+		epoll_ctl(epollFd, EPOLL_CTL_MOD, c.fd, &ev);
+		c.wantWrite = want;
+	}
+}
+
+void GameServer::drop(uint64_t id) {
+	Connection& c = conns[id];
+	if (c.fd < 0) return;
+
+	if (c.match) finishMatch(c.match, c.seat ^ 1, "forfeit");
+	if (!c.queue.empty()) {
+		auto& q = queues[c.queue];
+		q.erase(remove_if(q.begin(), q.end(), [&](const Seat& s) { return s.conn == id; }), q.end());
+		c.queue.clear();
+	}
+
+	::close(c.fd);	//Also leaves the epoll set
+	c.fd = -1;
+	closed.push_back(id);
+}
+
+void GameServer::send(uint64_t id, const string& line) {
+	Connection& c = conns[id];
+	if (c.fd < 0) return;
+
+	if (c.out.empty()) dirty.push_back(id);
+	c.out += line;
+	c.out += '\n';
+	if (c.out.size() > config.maxPendingOutput) drop(id);
+}
+
+void GameServer::closeAll() {
+	for (auto& entry : conns) {
+		if (entry.second.fd >= 0) ::close(entry.second.fd);
+		entry.second.fd = -1;
+	}
+	conns.clear();
+	matches.clear();
+	queues.clear();
+
+	if (listenFd >= 0) {
+		::close(listenFd);
+		if (!config.unixPath.empty()) ::unlink(config.unixPath.c_str());
+	}
+	if (epollFd >= 0) ::close(epollFd);
+	listenFd = epollFd = -1;
+}
+
+#else
+
+// -- Other Platforms --
+
+GameServer::~GameServer() {}
+
+bool GameServer::start(string& error) {
+	error = "The match server needs Linux (epoll)";
+	return false;
+}
+
+void GameServer::run() {}
+void GameServer::stop() { stopping.store(true); }
+void GameServer::acceptAll() {}
+void GameServer::readFrom(uint64_t) {}
+void GameServer::flush(uint64_t) {}
+void GameServer::drop(uint64_t) {}
+void GameServer::send(uint64_t, const string&) {}
+void GameServer::closeAll() {}
+
+#endif
+
+
+// -- Commands --
+
+void GameServer::handleLine(uint64_t id, const string& line) {
+	Connection& c = conns[id];
+	auto [command, rest] = splitCommand(line);
+
+	if (command == "PLACE" || command == "SWAP" || command == "SHIFT") {
+		Action action;
+		if (!c.match) {
+			++counters.protocolErrors;
+			send(id, "ERR not_in_match");
+		}
+		else if (!parseWireAction(line, action)) {
+			++counters.protocolErrors;
+			send(id, "ERR malformed");
+			if (matches[c.match].turn % 2 == c.seat) sendTurn(matches[c.match]);
+		}
+		else {
+			playAction(id, action);
+		}
+	}
+	else if (command == "PLAY") {
+		auto [mode, args] = splitCommand(rest);
+		Archetype archetype = Archetype::None;
+		string room = args;
+		if (mode == "battle") {
+			auto [arch, afterArch] = splitCommand(args);
+			archetype = (arch == "alchemist") ? Archetype::Alchemist : (arch == "paladin") ? Archetype::Paladin : Archetype::None;
+			room = afterArch;
+		}
+
+		if (c.match || !c.queue.empty()) send(id, "ERR busy");
+		else if (mode != "regular" && mode != "battle") send(id, "ERR bad_mode");
+		else if (mode == "battle" && archetype == Archetype::None) send(id, "ERR bad_archetype");
+		else enqueue(id, mode == "battle" ? Mode::Battle : Mode::Regular, archetype, room);
+	}
+	else if (command == "NAME") {
+		//Names go out inside START lines, keep them one short word
+		string name = rest.substr(0, 32);
+		replace_if(name.begin(), name.end(), [](char ch) { return ch <= ' ' || ch > '~'; }, '_');
+		if (!name.empty()) c.name = name;
+	}
+	else if (command == "QUIT") {
+		send(id, "BYE");
+		c.closing = true;
+	}
+	else if (!command.empty()) {
+		++counters.protocolErrors;
+		send(id, "ERR unknown_command");
+	}
+}
+
+void GameServer::enqueue(uint64_t id, Mode mode, Archetype archetype, const string& room) {
+	string key = (mode == Mode::Battle ? "battle/" : "regular/") + room;
+	auto& q = queues[key];
+	if (!q.empty()) {
+		Seat first = q.front();
+		q.pop_front();
+		conns[first.conn].queue.clear();
+		startMatch(mode, first, Seat{ id, archetype });
+		return;
+	}
+
+	q.push_back(Seat{ id, archetype });
+	conns[id].queue = key;
+	send(id, "WAIT");
+}
+
+void GameServer::startMatch(Mode mode, const Seat& a, const Seat& b) {
+	uint64_t matchId = nextMatch++;
+	Match& m = matches[matchId];
+	m.mode = mode;
+	m.conns[0] = a.conn;
+	m.conns[1] = b.conn;
+	m.archetypes[0] = a.archetype;
+	m.archetypes[1] = b.archetype;
+
+	for (int seat = 0; seat < 2; ++seat) {
+		Connection& c = conns[m.conns[seat]];
+		c.match = matchId;
+		c.seat = seat;
+	}
+	for (int seat = 0; seat < 2; ++seat) {
+		send(m.conns[seat], "START " + to_string(seat + 1) + " " + seatMarks[seat] + " "
+			+ (mode == Mode::Battle ? "battle " : "regular ") + conns[m.conns[seat ^ 1]].name);
+	}
+
+	++counters.matchesStarted;
+	sendTurn(m);
+}
+
+void GameServer::sendTurn(const Match& match) {
+	send(match.conns[match.turn % 2], "TURN " + boardText(match.board));
+}
+
+void GameServer::playAction(uint64_t id, const Action& action) {
+	Connection& c = conns[id];
+	uint64_t matchId = c.match;
+	Match& m = matches[matchId];
+	int seat = c.seat;
+
+	if (m.turn % 2 != seat) {
+		++counters.protocolErrors;
+		send(id, "ERR not_your_turn");
+		return;
+	}
+
+	//The same checks the console game runs
+	Archetype arch = (m.mode == Mode::Battle) ? m.archetypes[seat] : Archetype::None;
+	ActionError error = validateAction(m.board, action, arch);
+	if (error != ActionError::None) {
+		++counters.rejected;
+		send(id, string("ERR ") + actionErrorName(error));
+		sendTurn(m);
+		return;
+	}
+
+	applyAction(m.board, action, seatMarks[seat]);
+	++counters.moves;
+	send(m.conns[seat ^ 1], "OPP " + formatWireAction(action));
+
+	char winner = winnerAfter(m.board, action);
+	if (winner != ' ') {
+		finishMatch(matchId, winner == seatMarks[0] ? 0 : 1, nullptr);
+	}
+	else if (m.board.isDraw()) {
+		finishMatch(matchId, -1, nullptr);
+	}
+	else if (m.mode == Mode::Battle && config.battleTurnLimit > 0 && m.turn + 1 >= config.battleTurnLimit) {
+		finishMatch(matchId, -1, "limit");
+	}
+	else {
+		++m.turn;
+		sendTurn(m);
+	}
+}
+
+void GameServer::finishMatch(uint64_t matchId, int winnerSeat, const char* reason) {
+	auto it = matches.find(matchId);
+	if (it == matches.end()) return;
+	Match m = it->second;
+	matches.erase(it);
+
+	string turns = to_string(m.turn + 1);
+	string suffix = reason ? string(" ") + reason : "";
+	for (int seat = 0; seat < 2; ++seat) {
+		Connection& c = conns[m.conns[seat]];
+		c.match = 0;
+		const char* result = (winnerSeat == -1) ? "TIE" : (winnerSeat == seat) ? "WIN" : "LOSS";
+		send(m.conns[seat], string("END ") + result + " " + turns + suffix);
+	}
+
+	++counters.matchesFinished;
+	if (reason && string(reason) == "forfeit") ++counters.forfeits;
+}
+
+
+// ------------- Loopback Harness -------------
+
+#if defined(__linux__)
+namespace {
+	// One scripted client on a blocking socket. Keeps its own copy of the board
+	// and checks every TURN, OPP, ERR and END against it.
+	class LoopbackBot {
+	public:
+		LoopbackBot(int index, const LoopbackConfig& config, int port)
+			: index(index), config(config), port(port), rng(config.seed, static_cast<uint64_t>(index)) {
+			arch = !config.battle ? Archetype::None : (index % 2 == 0) ? Archetype::Alchemist : Archetype::Paladin;
+		}
+
+		~LoopbackBot() { if (fd >= 0) ::close(fd); }
+
+		uint64_t games = 0;
+		string error;
+
+		void run() {
+			if (!connectTo()) return;
+			string line;
+			if (!readLine(line) || line != "HELLO tictactoe 1") {
+				fail("bad greeting '" + line + "'");
+				return;
+			}
+			sendLine("NAME bot" + to_string(index));
+
+			string play = config.battle
+				? string("PLAY battle ") + (arch == Archetype::Alchemist ? "alchemist" : "paladin")
+				: string("PLAY regular");
+			play += " pair" + to_string(index / 2);
+
+			for (int g = 0; g < config.gamesPerBot && error.empty(); ++g) {
+				sendLine(play);
+				if (!playGame()) return;
+				++games;
+			}
+
+			sendLine("QUIT");
+			if (error.empty() && (!readLine(line) || line != "BYE")) fail("expected BYE, got '" + line + "'");
+		}
+
+	private:
+		int index;
+		const LoopbackConfig& config;
+		int port;
+		Rng rng;
+		Archetype arch;
+		int fd = -1;
+		string buffer;
+
+		Board board;
+		char mine = 'X', theirs = 'O';
+
+		bool fail(const string& what) {
+			if (error.empty()) error = "bot" + to_string(index) + ": " + what;
+			return false;
+		}
+
+		bool connectTo() {
+			fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+			timeval timeout{ 10, 0 };	//A stuck match fails the run instead of hanging it
+			setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+			int on = 1;
+			setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+			sockaddr_in addr{};
+			addr.sin_family = AF_INET;
+			addr.sin_port = htons(static_cast<uint16_t>(port));
+			addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+			if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+				return fail(string("connect: ") + strerror(errno));
+			}
+			return true;
+		}
+
+		void sendLine(const string& line) {
+			string data = line + "\n";
+			size_t sent = 0;
+			while (sent < data.size()) {
+				ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+				if (n <= 0) {
+					if (n < 0 && errno == EINTR) continue;
+					fail("send failed");
+					return;
+				}
+				sent += static_cast<size_t>(n);
+			}
+		}
+
+		bool readLine(string& line) {
+			while (true) {
+				size_t end = buffer.find('\n');
+				if (end != string::npos) {
+					line = buffer.substr(0, end);
+					buffer.erase(0, end + 1);
+					return true;
+				}
+				char chunk[512];
+				ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+				if (n < 0 && errno == EINTR) continue;
+				if (n <= 0) {
+					line.clear();
+					return fail(n == 0 ? "server closed the connection" : "timed out waiting for the server");
+				}
+				buffer.append(chunk, static_cast<size_t>(n));
+			}
+		}
+
+		//Something the local rules refuse, along with the reason the server should give
+		Action illegalAction(ActionError& expected) {
+			Action tries[4] = {
+				Action::place(9),	//"PLACE 10"
+				Action::place(static_cast<int>(rng.below(9))),
+				arch == Archetype::Alchemist ? Action::shift(0, 1) : Action::swap(0, 1),
+				Action::shift(static_cast<int>(rng.below(9)), static_cast<int>(rng.below(9)))
+			};
+			for (uint32_t start = rng.below(4), k = 0; k < 4; ++k) {
+				const Action& a = tries[(start + k) % 4];
+				expected = validateAction(board, a, arch);
+				if (expected != ActionError::None) return a;
+			}
+			expected = ActionError::OutOfRange;
+			return tries[0];
+		}
+
+		bool playGame() {
+			board.clearBoard();
+			string line;
+			do {
+				if (!readLine(line)) return false;
+			} while (line == "WAIT");
+
+			istringstream start(line);
+			string word, seat, mark, mode;
+			if (!(start >> word >> seat >> mark >> mode) || word != "START" || mode != (config.battle ? "battle" : "regular")) {
+				return fail("bad START '" + line + "'");
+			}
+			mine = mark[0];
+			theirs = (mine == 'X') ? 'O' : 'X';
+
+			while (true) {
+				if (!readLine(line)) return false;
+				auto [command, rest] = splitCommand(line);
+
+				if (command == "TURN") {
+					if (rest != boardText(board)) return fail("TURN " + rest + " but expected " + boardText(board));
+					if (!takeTurn()) return false;
+				}
+				else if (command == "OPP") {
+					Action action;
+					if (!parseWireAction(rest, action)) return fail("bad OPP '" + line + "'");
+					Archetype oppArch = !config.battle ? Archetype::None : (arch == Archetype::Alchemist) ? Archetype::Paladin : Archetype::Alchemist;
+					if (validateAction(board, action, oppArch) != ActionError::None) return fail("server relayed an illegal move '" + line + "'");
+					applyAction(board, action, theirs);
+				}
+				else if (command == "END") {
+					return checkEnd(rest);
+				}
+				else {
+					return fail("unexpected '" + line + "'");
+				}
+			}
+		}
+
+		bool takeTurn() {
+			if (config.illegalPercent > 0 && rng.below(100) < static_cast<uint32_t>(config.illegalPercent)) {
+				ActionError expected;
+				Action bad = illegalAction(expected);
+				sendLine(formatWireAction(bad));
+
+				string reply;
+				if (!readLine(reply)) return false;
+				if (reply != string("ERR ") + actionErrorName(expected)) {
+					return fail("sent " + formatWireAction(bad) + ", expected ERR " + actionErrorName(expected) + ", got '" + reply + "'");
+				}
+				return true;	//Server repeats TURN
+			}
+
+			ActionList actions;
+			generateActions(Position::fromBoard(board, mine, theirs, 0), arch, actions);
+			if (actions.count == 0) return fail("no legal move on " + boardText(board));
+			Action action = actions.moves[rng.below(static_cast<uint32_t>(actions.count))];
+			applyAction(board, action, mine);
+			sendLine(formatWireAction(action));
+			return true;
+		}
+
+		bool checkEnd(const string& rest) {
+			istringstream in(rest);
+			string result, reason;
+			int turns = 0;
+			in >> result >> turns >> reason;
+
+			string expected = !board.hasWinner() ? "TIE" : (board.winner() == mine) ? "WIN" : "LOSS";
+			if (reason == "forfeit") return fail("opponent forfeited");
+			if (result != expected) return fail("END " + rest + " but the board says " + expected);
+			if (reason == "limit" && (!config.battle || board.hasWinner() || board.isDraw())) return fail("unexpected turn limit");
+			if (reason.empty() && !board.hasWinner() && !board.isDraw()) return fail("END " + rest + " on an open board");
+			return true;
+		}
+	};
+}
+
+LoopbackReport runLoopback(const LoopbackConfig& config) {
+	LoopbackReport report;
+	ServerConfig serverConfig;
+	serverConfig.port = 0;
+	GameServer server(serverConfig);
+	if (!server.start(report.firstError)) {
+		report.errors = 1;
+		return report;
+	}
+
+	auto begin = chrono::steady_clock::now();
+	thread serving([&]() { server.run(); });
+
+	int botCount = max(2, config.bots + (config.bots & 1));
+	vector<unique_ptr<LoopbackBot>> bots;
+	for (int i = 0; i < botCount; ++i) bots.push_back(make_unique<LoopbackBot>(i, config, server.port()));
+
+	vector<thread> clients;
+	for (auto& bot : bots) clients.emplace_back([&bot]() { bot->run(); });
+	for (thread& t : clients) t.join();
+
+	for (auto& bot : bots) {
+		report.gamesPlayed += bot->games;
+		if (!bot->error.empty()) {
+			if (report.errors++ == 0) report.firstError = bot->error;
+		}
+	}
+	bots.clear();	//Closes the sockets
+
+	server.stop();
+	serving.join();
+	report.seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+	report.server = server.stats();
+
+	//The server's own tally has to agree with what the bots saw
+	uint64_t expected = static_cast<uint64_t>(botCount / 2) * static_cast<uint64_t>(max(0, config.gamesPerBot));
+	if (report.errors == 0 && (report.server.matchesFinished != expected || report.server.forfeits != 0)) {
+		report.errors = 1;
+		report.firstError = "server finished " + to_string(report.server.matchesFinished) + " matches (" + to_string(report.server.forfeits)
+			+ " forfeits), expected " + to_string(expected);
+	}
+	return report;
+}
+#else
+LoopbackReport runLoopback(const LoopbackConfig&) {
+	LoopbackReport report;
+	report.errors = 1;
+	report.firstError = "The match server needs Linux (epoll)";
+	return report;
+}
+#endif
+
+
+// -- Command Line --
+
+namespace {
+	GameServer* signalTarget = nullptr;
+
+	void stopOnSignal(int) {
+		if (signalTarget) signalTarget->stop();
+	}
+}
+
+int runServerCommand(int argc, char* argv[]) {
+	ServerConfig config;
+	auto usage = [](const string& problem) {
+		cerr << problem << "\n"
+			<< "Usage: --server [--port N] [--bind <address>] [--unix <path>] [--turn-limit N]\n";
+		return 1;
+	};
+
+	for (int i = 0; i < argc; ++i) {
+		string arg = argv[i];
+		string value = (i + 1 < argc) ? argv[i + 1] : "";
+
+		if (arg == "--port" && !value.empty()) {
+			if (!parseInt(value, config.port, 0, 65535)) return usage("Invalid port: " + value);
+			++i;
+		}
+		else if (arg == "--bind" && !value.empty()) { config.bindAddress = value; ++i; }
+		else if (arg == "--unix" && !value.empty()) { config.unixPath = value; ++i; }
+		else if (arg == "--turn-limit" && !value.empty()) {
+			if (!parseInt(value, config.battleTurnLimit, 0)) return usage("Invalid turn limit: " + value);
+			++i;
+		}
+		else {
+			return usage("Unknown option: " + arg);
+		}
+	}
+
+	GameServer server(config);
+	string error;
+	if (!server.start(error)) {
+		cerr << "Could not start the server: " << error << "\n";
+		return 1;
+	}
+
+	if (config.unixPath.empty()) cout << "Listening on " << config.bindAddress << ":" << server.port() << "\n";
+	else cout << "Listening on " << config.unixPath << "\n";
+	cout << "(Ctrl+C to stop.)" << endl;
+
+#if defined(__linux__)
+	signalTarget = &server;
+	signal(SIGINT, stopOnSignal);
+	signal(SIGTERM, stopOnSignal);
+#endif
+	server.run();
+	signalTarget = nullptr;
+
+	const ServerStats& s = server.stats();
+	cout << "\n" << s.connections << " connections, " << s.matchesStarted << " matches started, " << s.matchesFinished << " finished ("
+		<< s.forfeits << " forfeits)\n"
+		<< s.moves << " moves, " << s.rejected << " rejected, " << s.protocolErrors << " protocol errors\n";
+	return 0;
+}
+
+int runLoopbackCommand(int argc, char* argv[]) {
+	LoopbackConfig config;
+	auto usage = [](const string& problem) {
+		cerr << problem << "\n"
+			<< "Usage: --loopback [bots] [--games N] [--mode regular|battle] [--illegal <percent>] [--seed N]\n";
+		return 1;
+	};
+
+	for (int i = 0; i < argc; ++i) {
+		string arg = argv[i];
+		string value = (i + 1 < argc) ? argv[i + 1] : "";
+
+		if (arg == "--games" && !value.empty()) {
+			if (!parseInt(value, config.gamesPerBot, 1)) return usage("Invalid game count: " + value);
+			++i;
+		}
+		else if (arg == "--mode" && !value.empty()) { config.battle = (value == "battle"); ++i; }
+		else if (arg == "--illegal" && !value.empty()) {
+			if (!parseInt(value, config.illegalPercent, 0, 100)) return usage("Invalid percentage: " + value);
+			++i;
+		}
+		else if (arg == "--seed" && !value.empty()) {
+			if (!parseUint64(value, config.seed)) return usage("Invalid seed: " + value);
+			++i;
+		}
+		else if (!arg.empty() && isdigit(static_cast<unsigned char>(arg[0]))) {
+			if (!parseInt(arg, config.bots, 1)) return usage("Invalid bot count: " + arg);
+		}
+		else {
+			return usage("Unknown option: " + arg);
+		}
+	}
+
+	LoopbackReport report = runLoopback(config);
+	const ServerStats& s = report.server;
+	double matchesPerSecond = report.seconds > 0 ? s.matchesFinished / report.seconds : 0.0;
+	double movesPerSecond = report.seconds > 0 ? s.moves / report.seconds : 0.0;
+
+	cout << fixed << setprecision(2)
+		<< "Loopback: " << report.gamesPlayed / 2 << " matches, " << s.moves << " moves in " << report.seconds << "s\n"
+		<< "  " << setprecision(0) << matchesPerSecond << " matches/s, " << movesPerSecond << " moves/s\n"
+		<< "  " << s.rejected << " illegal moves refused, " << s.protocolErrors << " protocol errors, " << s.forfeits << " forfeits\n";
+
+	if (report.errors) {
+		cout << "  " << report.errors << " errors, first: " << report.firstError << "\n";
+		return 1;
+	}
+	cout << "  No errors\n";
+	return 0;
+}
@@ -0,0 +1,169 @@
+#pragma once
+
+#include "Rules.h"
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+// ------------- Match Server -------------
+
+// Hosts many Regular/Battle matches over TCP or a Unix socket from one thread:
+// an epoll loop over non-blocking sockets, no thread per connection. Moves are
+// checked with validateAction/applyAction on the server's own Board, so a
+// client can't place on a taken cell or swap without being an Alchemist.
+// Linux only; elsewhere start() fails with a message.
+//
+// Line protocol, one message per '\n', cells numbered 1-9:
+//   client -> server                      server -> client
+//   NAME <name>                           HELLO tictactoe 1
+//   PLAY regular [room]                   WAIT                      (queued for an opponent)
+//   PLAY battle alchemist|paladin [room]  START <seat 1|2> <X|O> <mode> <opponent>
+//   PLACE <cell>                          TURN <9 cells, X/O/.>     (your move)
+//   SWAP <cell> <cell>                    OPP <action>              (opponent's move, same syntax)
+//   SHIFT <from> <to>                     ERR <reason>              (then TURN again if it was a move)
+//   QUIT                                  END WIN|LOSS|TIE <turns> [forfeit|limit]
+//                                         BYE
+// Players naming the same room are paired with each other only; without one
+// they share the public queue. After END the client may PLAY again.
+
+struct ServerConfig {
+	std::string bindAddress = "127.0.0.1";
+	int port = 7777;				//0 = any free port, see GameServer::port()
+	std::string unixPath;			//Listen on this Unix socket instead of TCP
+	int battleTurnLimit = 200;		//Swaps and shifts can cycle forever, 0 = no limit
+	size_t maxLineLength = 256;		//Longer lines drop the connection
+	size_t maxPendingOutput = 64 * 1024;	//A client this far behind is dropped
+};
+
+struct ServerStats {
+	uint64_t connections = 0;
+	uint64_t matchesStarted = 0;
+	uint64_t matchesFinished = 0;
+	uint64_t forfeits = 0;		//Included in matchesFinished
+	uint64_t moves = 0;
+	uint64_t rejected = 0;		//Moves refused by the rules
+	uint64_t protocolErrors = 0;	//Unknown or malformed commands
+};
+
+//"PLACE 5" / "SWAP 1 9" / "SHIFT 1 2"
+std::string formatWireAction(const Action& action);
+
+//False on anything that isn't a well-formed action line; legality is checked separately
+bool parseWireAction(const std::string& line, Action& action);
+
+const char* actionErrorName(ActionError error);
+
+class GameServer {
+public:
+	explicit GameServer(const ServerConfig& config = ServerConfig()) : config(config) {}
+	~GameServer();
+
+	GameServer(const GameServer&) = delete;
+	GameServer& operator=(const GameServer&) = delete;
+
+	//Binds and listens; false with the reason in error
+	bool start(std::string& error);
+
+	//Serves until stop(); call after start()
+	void run();
+
+	//Safe from any thread and from a signal handler
+	void stop();
+
+	int port() const { return boundPort; }
+
+	//Only consistent once run() has returned
+	const ServerStats& stats() const { return counters; }
+
+private:
+	enum class Mode { Regular, Battle };
+
+	struct Connection {
+		int fd = -1;
+		std::string name;
+		std::string in;
+		std::string out;
+		uint64_t match = 0;		//0 = not in a match
+		int seat = 0;
+		std::string queue;		//Queue key while waiting, empty otherwise
+		bool closing = false;	//Close once out is flushed
+		bool wantWrite = false;	//EPOLLOUT registered
+	};
+
+	struct Seat {
+		uint64_t conn;
+		Archetype archetype;
+	};
+
+	struct Match {
+		Mode mode = Mode::Regular;
+		Board board;
+		uint64_t conns[2] = { 0, 0 };
+		Archetype archetypes[2] = { Archetype::None, Archetype::None };
+		int turn = 0;			//Seat turn % 2 is to move
+	};
+
+	ServerConfig config;
+	ServerStats counters;
+	int boundPort = 0;
+
+	int listenFd = -1;
+	int epollFd = -1;
+	int wakeFd = -1;
+	std::atomic<bool> stopping{ false };
+
+	uint64_t nextId = 2;		//0 = listener, 1 = wake event
+	uint64_t nextMatch = 1;		//0 = not in a match
+	std::unordered_map<uint64_t, Connection> conns;
+	std::unordered_map<uint64_t, Match> matches;
+	std::unordered_map<std::string, std::deque<Seat>> queues;	//Waiting players by mode + room
+	std::vector<uint64_t> dirty;	//Connections with output to flush after this pass
+	std::vector<uint64_t> closed;	//Dropped this pass, erased after it
+
+	void acceptAll();
+	void readFrom(uint64_t id);
+	void flush(uint64_t id);
+	void drop(uint64_t id);
+	void send(uint64_t id, const std::string& line);
+
+	void handleLine(uint64_t id, const std::string& line);
+	void enqueue(uint64_t id, Mode mode, Archetype archetype, const std::string& room);
+	void startMatch(Mode mode, const Seat& a, const Seat& b);
+	void sendTurn(const Match& match);
+	void playAction(uint64_t id, const Action& action);
+	void finishMatch(uint64_t matchId, int winnerSeat, const char* reason);
+	void closeAll();
+};
+
+
+// ------------- Loopback Harness -------------
+
+// Runs a server on 127.0.0.1 plus scripted bot clients in the same process.
+// Bots play random legal actions, and now and then an illegal one that the
+// server must refuse; any disagreement with the local rules is an error.
+struct LoopbackConfig {
+	int bots = 8;				//Rounded up to an even number
+	int gamesPerBot = 50;
+	bool battle = false;
+	int illegalPercent = 10;	//Chance a bot tries a move its own rules reject
+	uint64_t seed = 1;
+};
+
+struct LoopbackReport {
+	ServerStats server;
+	uint64_t gamesPlayed = 0;	//Counted by the bots, two per match
+	uint64_t errors = 0;
+	double seconds = 0.0;
+	std::string firstError;
+};
+
+LoopbackReport runLoopback(const LoopbackConfig& config);
+
+// -- Command Line --
+int runServerCommand(int argc, char* argv[]);
+int runLoopbackCommand(int argc, char* argv[]);
@@ -0,0 +1,237 @@
+#include "Simulator.h"
+#include "Console.h"
+#include "ThreadPool.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+
+// ------------- Scripted Hero -------------
+
+ScriptedCampaignController::ScriptedCampaignController(Archetype archetype, const HeroPolicy& policy, EnemyStrategy enemy, const Rng& rng)
+	: archetype(archetype), policy(policy), enemy(enemy), rng(rng), hero(policy.boardPlay) {
+	hero.rng = &this->rng;
+}
+
+void ScriptedCampaignController::createHero(string& name, Archetype& arch) {
+	name = "Sim Hero";
+	arch = archetype;
+}
+
+CampaignPath ScriptedCampaignController::choosePath() {
+	switch (policy.path) {
+	case PathPolicy::Wandered:   return CampaignPath::Wandered;
+	case PathPolicy::Wilderness: return CampaignPath::Wilderness;
+	case PathPolicy::Random:
+	default:                     return randomInt(rng, 0, 1) == 0 ? CampaignPath::Wandered : CampaignPath::Wilderness;
+	}
+}
+
+bool ScriptedCampaignController::touchShrine() {
+	switch (policy.shrine) {
+	case ShrinePolicy::Touch: return true;
+	case ShrinePolicy::Avoid: return false;
+	case ShrinePolicy::Random:
+	default:                  return randomInt(rng, 0, 1) == 0;
+	}
+}
+
+
+// ------------- Simulation -------------
+
+CampaignSummary simulateCampaign(Archetype archetype, const SimulationConfig& config, int index, ReplayWriter* replay) {
+	//Even streams drive the campaign, odd streams the scripted hero
+	uint64_t stream = 2 * static_cast<uint64_t>(index);
+	ScriptedCampaignController controller(archetype, config.policy, config.enemy, Rng(config.seed, stream + 1));
+
+	NullStream quiet;
+	CampaignGame game(controller, quiet);
+	game.savePath.clear();
+	game.roundLimit = config.roundLimit;
+	game.setRng(Rng(config.seed, stream));
+	game.replay = replay;
+	game.run();
+	return game.getSummary();
+}
+
+SimulationReport runSimulation(const SimulationConfig& config) {
+	SimulationReport report;
+	report.config = config;
+
+	ThreadPool pool(config.threads);
+	report.threadsUsed = pool.size();
+
+	vector<CampaignSummary> results(config.campaigns);
+
+	auto start = chrono::steady_clock::now();
+
+	pool.parallelFor(config.campaigns, [&](int i) {
+		results[i] = simulateCampaign(config.archetypes[i % config.archetypes.size()], config, i);
+	});
+
+	report.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+	//Reduce in index order so the totals never depend on scheduling
+	report.perArchetype.resize(config.archetypes.size());
+	for (size_t a = 0; a < config.archetypes.size(); ++a) {
+		report.perArchetype[a].archetype = config.archetypes[a];
+	}
+
+	for (int i = 0; i < config.campaigns; ++i) {
+		const CampaignSummary& s = results[i];
+		ArchetypeStats& st = report.perArchetype[i % config.archetypes.size()];
+
+		st.campaigns++;
+		st.rounds += s.roundsPlayed;
+		for (size_t stage = 0; stage < s.hpOnEntry.size(); ++stage) {
+			if (s.hpOnEntry[stage] < 0) continue;
+			st.reached[stage]++;
+			st.hpOnEntry[stage] += s.hpOnEntry[stage];
+		}
+
+		if (s.result == CampaignResult::Victory) {
+			st.victories++;
+			int bucket = s.heroMaxHP > 0 ? (10 * s.heroHP) / s.heroMaxHP : 0;
+			st.finalHP[min(bucket, 9)]++;
+		}
+		else if (s.result == CampaignResult::Defeat) {
+			st.defeats++;
+			if (0 <= s.endStage && s.endStage < 10) st.deaths[s.endStage]++;
+		}
+		else if (s.stalemate) {
+			st.stalemates++;
+		}
+	}
+
+	return report;
+}
+
+
+// ------------- Reporting -------------
+
+static const char* archetypeName(Archetype a) {
+	switch (a) {
+	case Archetype::Alchemist: return "Alchemist";
+	case Archetype::Paladin:   return "Paladin";
+	default:                   return "None";
+	}
+}
+
+void printReport(ostream& out, const SimulationReport& report) {
+	const SimulationConfig& c = report.config;
+	auto pct = [](long long part, long long whole) { return whole > 0 ? 100.0 * part / whole : 0.0; };
+
+	out << fixed << setprecision(1);
+	out << "Campaign simulation: " << c.campaigns << " campaigns, seed " << c.seed
+		<< ", " << report.threadsUsed << " threads, " << setprecision(2) << report.seconds << "s ("
+		<< setprecision(0) << (report.seconds > 0 ? c.campaigns / report.seconds : 0.0) << " campaigns/s)\n";
+	out << setprecision(1);
+
+	for (const ArchetypeStats& st : report.perArchetype) {
+		out << "\n" << archetypeName(st.archetype) << ": " << st.campaigns << " campaigns\n";
+		out << "  Win rate " << pct(st.victories, st.campaigns) << "%, defeats " << pct(st.defeats, st.campaigns)
+			<< "%, stalemates " << pct(st.stalemates, st.campaigns) << "%, "
+			<< (st.campaigns ? static_cast<double>(st.rounds) / st.campaigns : 0.0) << " rounds per campaign\n";
+
+		out << "  Stage  Reached  Deaths  Death rate  Avg HP on entry\n";
+		for (int stage = 1; stage < 10; ++stage) {
+			out << "  " << setw(5) << stage << "  " << setw(7) << st.reached[stage] << "  " << setw(6) << st.deaths[stage]
+				<< "  " << setw(9) << pct(st.deaths[stage], st.reached[stage]) << "%"
+				<< "  " << setw(15) << (st.reached[stage] ? static_cast<double>(st.hpOnEntry[stage]) / st.reached[stage] : 0.0) << "\n";
+		}
+
+		out << "  Final HP of victors (% of max HP):\n";
+		for (int b = 0; b < 10; ++b) {
+			out << "    " << setw(3) << b * 10 << "-" << setw(3) << (b * 10 + 9) << "%: " << setw(7) << st.finalHP[b]
+				<< " (" << pct(st.finalHP[b], st.victories) << "%)\n";
+		}
+	}
+}
+
+
+// ------------- Command Line -------------
+
+//False for an unknown name, so a typo is reported instead of playing Random
+static bool parseStrategy(const string& value, EnemyStrategy& strategy) {
+	if (value == "random") strategy = EnemyStrategy::Random;
+	else if (value == "perfect") strategy = EnemyStrategy::Perfect;
+	else if (value == "greedy") strategy = EnemyStrategy::Greedy;
+	else if (value == "search") strategy = EnemyStrategy::Search;
+	else if (value == "tiered") strategy = EnemyStrategy::Tiered;
+	else if (value == "mcts") strategy = EnemyStrategy::Mcts;
+	else return false;
+	return true;
+}
+
+int runSimulationCommand(int argc, char* argv[]) {
+	SimulationConfig config;
+	auto usage = [](const string& problem) {
+		cerr << problem << "\n"
+			<< "Usage: --simulate [campaigns] [--seed N] [--threads N] [--round-limit N]\n"
+			<< "       [--archetype alchemist|paladin|both] [--enemy random|greedy|search|perfect|tiered|mcts]\n"
+			<< "       [--hero random|greedy|search|perfect|mcts]\n"
+			<< "       [--path wandered|wilderness|random] [--shrine touch|avoid|random]\n";
+		return 1;
+	};
+
+	for (int i = 0; i < argc; ++i) {
+		string arg = argv[i];
+		string value = (i + 1 < argc) ? argv[i + 1] : "";
+
+		if (arg == "--seed" && !value.empty()) {
+			if (!parseUint64(value, config.seed)) return usage("Invalid seed: " + value);
+			++i;
+		}
+		else if (arg == "--threads" && !value.empty()) {
+			if (!parseInt(value, config.threads, 0)) return usage("Invalid thread count: " + value);
+			++i;
+		}
+		else if (arg == "--round-limit" && !value.empty()) {
+			if (!parseInt(value, config.roundLimit, 0)) return usage("Invalid round limit: " + value);
+			++i;
+		}
+		else if (arg == "--archetype" && !value.empty()) {
+			if (value == "alchemist") config.archetypes = { Archetype::Alchemist };
+			else if (value == "paladin") config.archetypes = { Archetype::Paladin };
+			else if (value == "both") config.archetypes = { Archetype::Alchemist, Archetype::Paladin };
+			else return usage("Unknown archetype: " + value);
+			++i;
+		}
+		else if (arg == "--enemy" && !value.empty()) {
+			if (!parseStrategy(value, config.enemy)) return usage("Unknown enemy strategy: " + value);
+			++i;
+		}
+		else if (arg == "--hero" && !value.empty()) {
+			//Tiered picks per enemy type, it means nothing for the hero
+			if (value == "tiered" || !parseStrategy(value, config.policy.boardPlay)) return usage("Unknown hero strategy: " + value);
+			++i;
+		}
+		else if (arg == "--path" && !value.empty()) {
+			if (value == "wandered") config.policy.path = PathPolicy::Wandered;
+			else if (value == "wilderness") config.policy.path = PathPolicy::Wilderness;
+			else if (value == "random") config.policy.path = PathPolicy::Random;
+			else return usage("Unknown path policy: " + value);
+			++i;
+		}
+		else if (arg == "--shrine" && !value.empty()) {
+			if (value == "touch") config.policy.shrine = ShrinePolicy::Touch;
+			else if (value == "avoid") config.policy.shrine = ShrinePolicy::Avoid;
+			else if (value == "random") config.policy.shrine = ShrinePolicy::Random;
+			else return usage("Unknown shrine policy: " + value);
+			++i;
+		}
+		else if (!arg.empty() && isdigit(static_cast<unsigned char>(arg[0]))) {
+			if (!parseInt(arg, config.campaigns, 1)) return usage("Invalid campaign count: " + arg);
+		}
+		else {
+			return usage("Unknown option: " + arg);
+		}
+	}
+
+	printReport(cout, runSimulation(config));
+	return 0;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "Engine.h"
+
+#include <vector>
+#include <ostream>
+
+
+// ------------- Campaign Simulator -------------
+
+// Plays whole campaigns with no one at the keyboard so enemy stats and event
+// payoffs can be tuned from numbers instead of by hand. Campaign i always draws
+// from Rng stream i of the run seed, so a run is reproducible no matter how
+// many threads it uses.
+
+enum class PathPolicy { Wandered, Wilderness, Random };
+enum class ShrinePolicy { Touch, Avoid, Random };
+
+struct HeroPolicy {
+	EnemyStrategy boardPlay = EnemyStrategy::Random;	//How the hero picks cells
+	PathPolicy path = PathPolicy::Random;
+	ShrinePolicy shrine = ShrinePolicy::Random;
+};
+
+// Answers every campaign question from a HeroPolicy and its own seeded engine
+class ScriptedCampaignController : public CampaignController {
+public:
+	ScriptedCampaignController(Archetype archetype, const HeroPolicy& policy, EnemyStrategy enemy, const Rng& rng);
+
+	bool continueSavedCampaign(const Player&, int) override { return false; }
+	void createHero(std::string& name, Archetype& arch) override;
+	EnemyStrategy chooseEnemyStrategy() override { return enemy; }
+	bool quitBeforeBattle(int) override { return false; }
+	CampaignPath choosePath() override;
+	bool touchShrine() override;
+
+	PlayerController& heroController() override { return hero; }
+
+private:
+	Archetype archetype;
+	HeroPolicy policy;
+	EnemyStrategy enemy;
+	Rng rng;
+	StrategyController hero;
+};
+
+struct SimulationConfig {
+	uint64_t seed = 1;
+	int campaigns = 10000;
+	int threads = 0;	//0 = one per core
+	std::vector<Archetype> archetypes{ Archetype::Alchemist, Archetype::Paladin };	//Campaign i uses archetypes[i % size]
+	HeroPolicy policy;
+	EnemyStrategy enemy = EnemyStrategy::Random;
+	int roundLimit = 50;	//Per battle, keeps perfect-vs-perfect from tying forever
+};
+
+struct ArchetypeStats {
+	Archetype archetype = Archetype::None;
+	int campaigns = 0;
+	int victories = 0;
+	int defeats = 0;
+	int stalemates = 0;
+	long long rounds = 0;
+	std::array<int, 10> reached{};			//Campaigns that started each stage
+	std::array<int, 10> deaths{};			//Defeats at each stage
+	std::array<long long, 10> hpOnEntry{};	//Summed over the campaigns that reached the stage
+	std::array<int, 10> finalHP{};			//Victories by final HP, 10% of max HP per bucket
+};
+
+struct SimulationReport {
+	SimulationConfig config;
+	std::vector<ArchetypeStats> perArchetype;
+	int threadsUsed = 0;
+	double seconds = 0.0;
+};
+
+CampaignSummary simulateCampaign(Archetype archetype, const SimulationConfig& config, int index, ReplayWriter* replay = nullptr);
+SimulationReport runSimulation(const SimulationConfig& config);
+void printReport(std::ostream& out, const SimulationReport& report);
+
+//Entry point for "--simulate [campaigns] [options]"
+int runSimulationCommand(int argc, char* argv[]);
@@ -0,0 +1,52 @@
+#include "Solver.h"
+
+using namespace std;
+
+
+Solver::Solver() {
+	for (int code = 0; code < positions; ++code) {
+		Mask mover = 0, opponent = 0;
+		int rest = code;
+		for (int i = 0; i < 9; ++i, rest /= 3) {
+			if (rest % 3 == 1) mover |= cellBit(i);
+			if (rest % 3 == 2) opponent |= cellBit(i);
+		}
+		solve(mover, opponent);
+	}
+}
+
+bool Solver::hasLine(Mask m) {
+	for (Mask line : win_masks) {
+		if ((m & line) == line) return true;
+	}
+	return false;
+}
+
+int Solver::solve(Mask mover, Mask opponent) {
+	int code = encode(mover, opponent);
+	if (solved[code]) return table[code].score;
+	solved[code] = true;
+
+	Mask empty = static_cast<Mask>(~(mover | opponent) & Board::fullMask);
+	int remaining = popCount(empty);
+	SolverEntry& e = table[code];
+
+	//Battle swaps can leave either side with a line, so check both
+	if (hasLine(opponent)) { e.score = static_cast<int8_t>(-(remaining + 1)); return e.score; }
+	if (hasLine(mover)) { e.score = static_cast<int8_t>(remaining + 1); return e.score; }
+	if (!empty) { e.score = 0; return 0; }
+
+	int best = -100;
+	for (int i = 0; i < 9; ++i) {
+		if (!(empty & cellBit(i))) continue;
+		Mask next = static_cast<Mask>(mover | cellBit(i));
+		//Completing a line ends the game right away, no need to recurse
+		int score = completesLineThrough(next, i) ? remaining : -solve(opponent, next);
+		if (score > best) {
+			best = score;
+			e.bestMove = static_cast<int8_t>(i);
+		}
+	}
+	e.score = static_cast<int8_t>(best);
+	return best;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "Board.h"
+
+
+// ------------- Perfect Play Solver -------------
+
+// Every 3x3 position is encoded in base 3 relative to the side to move:
+// digit i is 0 for an empty cell, 1 for the mover's mark, 2 for the opponent's.
+// All 3^9 codes are solved once on first use, so an AI turn is one lookup.
+struct SolverEntry {
+	int8_t score = 0;		//>0 Mover Wins, <0 Mover Loses, 0 Draw (bigger = sooner)
+	int8_t bestMove = -1;	//-1 when the position is already decided
+};
+
+class Solver {
+public:
+	static constexpr int positions = 19683; //3^9
+
+	static const Solver& instance() {
+		static const Solver solver; //Built once, thread-safe
+		return solver;
+	}
+
+	static int encode(Mask mover, Mask opponent) {
+		return base3()[mover] + 2 * base3()[opponent];
+	}
+
+	static int encode(const Board& b, char mover, char opponent) {
+		return encode(b.maskFor(mover), b.maskFor(opponent));
+	}
+
+	const SolverEntry& lookup(int code) const { return table[code]; }
+
+	int bestMove(const Board& b, char mover, char opponent) const {
+		return table[encode(b, mover, opponent)].bestMove;
+	}
+
+private:
+	std::array<SolverEntry, positions> table{};
+	std::array<bool, positions> solved{};
+
+	Solver();
+
+	//Sum of 3^i over the set bits of every 9-bit mask
+	static const std::array<int, 512>& base3() {
+		static const std::array<int, 512> t = [] {
+			std::array<int, 512> out{};
+			for (int m = 0; m < 512; ++m) {
+				int pow = 1;
+				for (int i = 0; i < 9; ++i, pow *= 3) {
+					if (m & (1 << i)) out[m] += pow;
+				}
+			}
+			return out;
+		}();
+		return t;
+	}
+
+	static bool hasLine(Mask m);
+	int solve(Mask mover, Mask opponent);
+};
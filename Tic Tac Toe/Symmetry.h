@@ -0,0 +1,162 @@
+#pragma once
+
+#include "Rules.h"
+#include "Solver.h"
+
+#include <vector>
+
+
+// ------------- Board Symmetries -------------
+
+// The 3x3 board has 8 symmetries (4 rotations, each optionally mirrored).
+// Symmetry s sends cell i to symmetry_perms[s][i]; s = 0 is the identity.
+// Bit 2 transposes, then bit 0 flips the rows and bit 1 flips the columns.
+constexpr int symmetryCount = 8;
+
+constexpr std::array<std::array<int8_t, 9>, symmetryCount> makeSymmetryPerms() {
+	std::array<std::array<int8_t, 9>, symmetryCount> out{};
+	for (int s = 0; s < symmetryCount; ++s) {
+		for (int idx = 0; idx < 9; ++idx) {
+			int r = idx / 3, c = idx % 3;
+			if (s & 4) { int t = r; r = c; c = t; }
+			if (s & 1) r = 2 - r;
+			if (s & 2) c = 2 - c;
+			out[s][idx] = static_cast<int8_t>(r * 3 + c);
+		}
+	}
+	return out;
+}
+
+inline constexpr std::array<std::array<int8_t, 9>, symmetryCount> symmetry_perms = makeSymmetryPerms();
+
+//inverse_symmetry[s] undoes symmetry s
+constexpr std::array<int8_t, symmetryCount> makeInverseSymmetries() {
+	std::array<int8_t, symmetryCount> out{};
+	for (int s = 0; s < symmetryCount; ++s) {
+		for (int t = 0; t < symmetryCount; ++t) {
+			bool undoes = true;
+			for (int idx = 0; idx < 9; ++idx) {
+				if (symmetry_perms[t][symmetry_perms[s][idx]] != idx) undoes = false;
+			}
+			if (undoes) out[s] = static_cast<int8_t>(t);
+		}
+	}
+	return out;
+}
+
+inline constexpr std::array<int8_t, symmetryCount> inverse_symmetry = makeInverseSymmetries();
+
+//Every 9-bit mask under every symmetry, so a transform is one lookup
+constexpr std::array<std::array<Mask, 512>, symmetryCount> makeSymmetryMasks() {
+	std::array<std::array<Mask, 512>, symmetryCount> out{};
+	for (int s = 0; s < symmetryCount; ++s) {
+		for (int m = 0; m < 512; ++m) {
+			for (int idx = 0; idx < 9; ++idx) {
+				if (m & (1 << idx)) out[s][m] |= cellBit(symmetry_perms[s][idx]);
+			}
+		}
+	}
+	return out;
+}
+
+inline constexpr std::array<std::array<Mask, 512>, symmetryCount> symmetry_masks = makeSymmetryMasks();
+
+static_assert(symmetry_perms[6][0] == 2 && symmetry_perms[6][2] == 8, "symmetry 6 turns the board a quarter clockwise");
+static_assert(inverse_symmetry[6] == 5 && inverse_symmetry[5] == 6, "quarter turns undo each other");
+static_assert(symmetry_masks[3][0x007] == 0x1C0, "a half turn sends the top row to the bottom row");
+
+//Adjacency and the winning lines look the same from every symmetry, which is what makes sharing results safe
+constexpr bool symmetriesKeepRules() {
+	for (int s = 0; s < symmetryCount; ++s) {
+		for (int idx = 0; idx < 9; ++idx) {
+			if (symmetry_masks[s][adjacency_masks[idx]] != adjacency_masks[symmetry_perms[s][idx]]) return false;
+		}
+		for (Mask line : win_masks) {
+			bool found = false;
+			for (Mask other : win_masks) found = found || (symmetry_masks[s][line] == other);
+			if (!found) return false;
+		}
+	}
+	return true;
+}
+
+static_assert(symmetriesKeepRules(), "a symmetry broke adjacency or the winning lines");
+
+inline Mask transformMask(Mask m, int s) { return symmetry_masks[s][m]; }
+
+inline int transformCell(int idx, int s) { return idx < 0 ? idx : symmetry_perms[s][idx]; }
+
+inline Action transformAction(const Action& m, int s) {
+	Action out = m;
+	out.a = static_cast<int8_t>(transformCell(m.a, s));
+	out.b = static_cast<int8_t>(transformCell(m.b, s));
+	return out;
+}
+
+inline Position transformPosition(const Position& p, int s) {
+	Position out = p;
+	out.marks[0] = transformMask(p.marks[0], s);
+	out.marks[1] = transformMask(p.marks[1], s);
+	return out;
+}
+
+
+// ------------- Canonical Positions -------------
+
+// A canonical code is the smallest base-3 code (Solver::encode) over all 8
+// symmetries, so every position in one symmetry class shares it. symmetry
+// is the transform taking the original onto the canonical orientation.
+struct Canonical {
+	int code = 0;
+	int symmetry = 0;
+
+	//Maps a move from the original board into the canonical orientation, and back
+	Action toCanonical(const Action& m) const { return transformAction(m, symmetry); }
+	Action fromCanonical(const Action& m) const { return transformAction(m, inverse_symmetry[symmetry]); }
+	int cellFromCanonical(int idx) const { return transformCell(idx, inverse_symmetry[symmetry]); }
+};
+
+inline Canonical canonicalize(Mask first, Mask second) {
+	Canonical best{ Solver::encode(first, second), 0 };
+	for (int s = 1; s < symmetryCount; ++s) {
+		int code = Solver::encode(transformMask(first, s), transformMask(second, s));
+		if (code < best.code) best = Canonical{ code, s };
+	}
+	return best;
+}
+
+//Seat 0's marks are the 1 digits, the side to move is folded into the low bit
+inline Canonical canonicalize(const Position& p) {
+	Canonical c = canonicalize(p.marks[0], p.marks[1]);
+	c.code = c.code * 2 + p.side;
+	return c;
+}
+
+//Mover-relative, the same code space as Solver::lookup
+inline Canonical canonicalize(const Board& b, char mover, char opponent) {
+	return canonicalize(b.maskFor(mover), b.maskFor(opponent));
+}
+
+
+// ------------- Transposition Cache -------------
+
+// Flat table indexed by canonical code; every code fits, so there is no
+// replacement policy and a probe never misses a stored entry. Entries keep
+// moves in the canonical orientation, callers map them back with
+// Canonical::fromCanonical. keys = Solver::positions for board codes,
+// 2 * Solver::positions for Position codes (side folded in).
+template<typename Entry>
+class TranspositionCache {
+public:
+	explicit TranspositionCache(int keys = 2 * Solver::positions) : table(static_cast<size_t>(keys)) {}
+
+	Entry& at(int code) { return table[static_cast<size_t>(code)]; }
+	const Entry& at(int code) const { return table[static_cast<size_t>(code)]; }
+
+	void clear() { table.assign(table.size(), Entry{}); }
+	bool empty() const { return table.empty(); }
+	size_t size() const { return table.size(); }
+
+private:
+	std::vector<Entry> table;
+};
@@ -0,0 +1,120 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+using namespace std;
+
+
+namespace {
+	thread_local int currentWorker = -1;
+}
+
+ThreadPool::ThreadPool(int threads) {
+	if (threads <= 0) threads = static_cast<int>(thread::hardware_concurrency());
+	if (threads <= 0) threads = 1;
+
+	for (int i = 0; i < threads; ++i) queues.push_back(make_unique<Queue>());
+	for (int i = 0; i < threads; ++i) workers.emplace_back([this, i] { workerLoop(i); });
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		lock_guard<mutex> lock(sleepMutex);
+		stopping = true;
+	}
+	wake.notify_all();
+	for (thread& t : workers) t.join();
+}
+
+int ThreadPool::workerIndex() {
+	return currentWorker;
+}
+
+void ThreadPool::submit(function<void()> task) {
+	//Workers keep their own children local; outside callers spread round-robin
+	int target = (currentWorker >= 0) ? currentWorker : static_cast<int>(nextQueue++ % queues.size());
+	{
+		lock_guard<mutex> lock(queues[target]->m);
+		queues[target]->tasks.push_back(move(task));
+	}
+	{
+		lock_guard<mutex> lock(sleepMutex);
+		++queued;
+		++pending;
+	}
+	wake.notify_one();
+}
+
+void ThreadPool::wait() {
+	unique_lock<mutex> lock(sleepMutex);
+	idle.wait(lock, [this] { return pending == 0; });
+}
+
+void ThreadPool::parallelFor(int count, const function<void(int)>& body) {
+	if (count <= 0) return;
+
+	//About eight chunks per worker leaves room for stealing without flooding the deques
+	int chunk = max(1, count / (size() * 8));
+	for (int begin = 0; begin < count; begin += chunk) {
+		int end = min(count, begin + chunk);
+		submit([&body, begin, end] {
+			for (int i = begin; i < end; ++i) body(i);
+		});
+	}
+	wait();
+}
+
+bool ThreadPool::tryPop(int id, function<void()>& task) {
+	//Own deque, newest first
+	{
+		Queue& q = *queues[id];
+		lock_guard<mutex> lock(q.m);
+		if (!q.tasks.empty()) {
+			task = move(q.tasks.back());
+			q.tasks.pop_back();
+			return true;
+		}
+	}
+
+	//Steal the oldest task from someone else
+	int n = static_cast<int>(queues.size());
+	for (int k = 1; k < n; ++k) {
+		Queue& q = *queues[(id + k) % n];
+		lock_guard<mutex> lock(q.m);
+		if (!q.tasks.empty()) {
+			task = move(q.tasks.front());
+			q.tasks.pop_front();
+			return true;
+		}
+	}
+	return false;
+}
+
+void ThreadPool::workerLoop(int id) {
+	currentWorker = id;
+
+	while (true) {
+		{
+			unique_lock<mutex> lock(sleepMutex);
+			wake.wait(lock, [this] { return stopping || queued > 0; });
+			if (stopping && queued == 0) return;
+		}
+
+		function<void()> task;
+		if (!tryPop(id, task)) continue;	//Another worker got there first
+
+		{
+			lock_guard<mutex> lock(sleepMutex);
+			--queued;
+		}
+
+		task();
+
+		bool done;
+		{
+			lock_guard<mutex> lock(sleepMutex);
+			done = (--pending == 0);
+		}
+		if (done) idle.notify_all();
+	}
+}
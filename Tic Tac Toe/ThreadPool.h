@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+// ------------- Work-Stealing Thread Pool -------------
+
+// One task deque per worker. A worker pops its own newest task first and,
+// when it runs dry, steals the oldest task from another worker, so uneven
+// jobs (a 5-turn game next to a 200-turn Battle) still keep every core busy.
+class ThreadPool {
+public:
+	explicit ThreadPool(int threads = 0);	//0 = one per core
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	int size() const { return static_cast<int>(workers.size()); }
+
+	void submit(std::function<void()> task);
+
+	//Blocks until every submitted task has finished
+	void wait();
+
+	//body(i) for every i in [0, count), handed out in chunks; returns when all are done.
+	//Call it from outside the pool, a worker waiting on itself would never wake.
+	void parallelFor(int count, const std::function<void(int)>& body);
+
+	//Index of the calling worker, -1 outside the pool
+	static int workerIndex();
+
+private:
+	struct Queue {
+		std::mutex m;
+		std::deque<std::function<void()>> tasks;
+	};
+
+	std::vector<std::unique_ptr<Queue>> queues;
+	std::vector<std::thread> workers;
+
+	std::mutex sleepMutex;
+	std::condition_variable wake;	//Work arrived or shutting down
+	std::condition_variable idle;	//pending hit zero
+	int queued = 0;					//Tasks sitting in a deque (guarded by sleepMutex)
+	int pending = 0;				//Tasks not finished yet (guarded by sleepMutex)
+	bool stopping = false;
+	std::atomic<unsigned> nextQueue{ 0 };
+
+	void workerLoop(int id);
+	bool tryPop(int id, std::function<void()>& task);
+};
@@ -0,0 +1,321 @@
+#include "Tournament.h"
+#include "Console.h"
+#include "Rng.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+
+using namespace std;
+
+
+namespace {
+
+	struct Fixture {
+		int entrants[2];	//By seat, seat 0 moves first
+		int variant;		//Index into the report's variants
+		bool rowFirst;		//entrants[0] is the lower entrant index
+	};
+
+	struct FixtureResult {
+		GameOutcome outcome;
+		uint64_t digest = 0;
+	};
+
+	bool isBattle(TournamentVariant v) { return v != TournamentVariant::Regular; }
+
+	//Archetype of the lower-indexed entrant, then the higher one
+	pair<Archetype, Archetype> variantArchetypes(TournamentVariant v) {
+		switch (v) {
+		case TournamentVariant::BattleAA: return { Archetype::Alchemist, Archetype::Alchemist };
+		case TournamentVariant::BattleAP: return { Archetype::Alchemist, Archetype::Paladin };
+		case TournamentVariant::BattlePA: return { Archetype::Paladin, Archetype::Alchemist };
+		case TournamentVariant::BattlePP: return { Archetype::Paladin, Archetype::Paladin };
+		default:                          return { Archetype::None, Archetype::None };
+		}
+	}
+
+	//Row entrant i met j in variant v with archetypes (a, b) - the same games, seen from j, are (b, a)
+	int mirroredVariant(const vector<TournamentVariant>& variants, int v) {
+		TournamentVariant mirror = variants[v];
+		if (mirror == TournamentVariant::BattleAP) mirror = TournamentVariant::BattlePA;
+		else if (mirror == TournamentVariant::BattlePA) mirror = TournamentVariant::BattleAP;
+		return static_cast<int>(find(variants.begin(), variants.end(), mirror) - variants.begin());
+	}
+
+	void addResult(TournamentScore& score, int result) {
+		if (result > 0) score.wins++;
+		else if (result < 0) score.losses++;
+		else score.ties++;
+	}
+
+	// Bradley-Terry strengths by minorization-maximization. One virtual tie per
+	// pair keeps an entrant that never scored (or never dropped a point) finite.
+	void fitRatings(TournamentReport& report) {
+		size_t n = report.standings.size();
+		vector<vector<double>> games(n, vector<double>(n, 0.0));
+		vector<double> points(n, 0.0);
+		for (size_t i = 0; i < n; ++i) {
+			for (size_t j = 0; j < n; ++j) {
+				if (i == j) continue;
+				const TournamentScore& s = report.headToHead[i][j];
+				games[i][j] = s.games() + 1.0;
+				points[i] += s.points() + 0.5;
+			}
+		}
+
+		vector<double> gamma(n, 1.0);
+		for (int iteration = 0; iteration < 10000; ++iteration) {
+			double change = 0.0;
+			vector<double> next(n);
+			for (size_t i = 0; i < n; ++i) {
+				double denominator = 0.0;
+				for (size_t j = 0; j < n; ++j) {
+					if (i != j) denominator += games[i][j] / (gamma[i] + gamma[j]);
+				}
+				next[i] = points[i] / denominator;
+			}
+
+			//Pin the geometric mean to 1, so the average rating stays put
+			double logMean = 0.0;
+			for (double g : next) logMean += log(g);
+			logMean /= static_cast<double>(n);
+			for (size_t i = 0; i < n; ++i) {
+				next[i] /= exp(logMean);
+				change = max(change, fabs(log(next[i] / gamma[i])));
+			}
+			gamma = next;
+			if (change < 1e-10) break;
+		}
+
+		const double eloPerNat = 400.0 / log(10.0);
+		for (size_t i = 0; i < n; ++i) {
+			//Fisher information of log(gamma_i), other ratings held fixed
+			double information = 0.0;
+			for (size_t j = 0; j < n; ++j) {
+				if (i == j) continue;
+				double p = gamma[i] / (gamma[i] + gamma[j]);
+				information += games[i][j] * p * (1.0 - p);
+			}
+			TournamentStanding& s = report.standings[i];
+			s.elo = 1500.0 + eloPerNat * log(gamma[i]);
+			s.eloMargin = information > 0 ? 1.96 * eloPerNat / sqrt(information) : 0.0;
+		}
+	}
+}
+
+
+const char* variantName(TournamentVariant variant) {
+	switch (variant) {
+	case TournamentVariant::BattleAA: return "battle-aa";
+	case TournamentVariant::BattleAP: return "battle-ap";
+	case TournamentVariant::BattlePA: return "battle-pa";
+	case TournamentVariant::BattlePP: return "battle-pp";
+	default:                          return "regular";
+	}
+}
+
+
+// ------------- Runner -------------
+
+TournamentReport runTournament(const TournamentConfig& config) {
+	TournamentReport report;
+	report.config = config;
+	report.config.gamesPerPairing += config.gamesPerPairing & 1;	//Both entrants move first equally often
+	const int gamesPerPairing = report.config.gamesPerPairing;
+	if (config.regular) report.variants.push_back(TournamentVariant::Regular);
+	if (config.battle) {
+		for (TournamentVariant v : { TournamentVariant::BattleAA, TournamentVariant::BattleAP, TournamentVariant::BattlePA, TournamentVariant::BattlePP }) {
+			report.variants.push_back(v);
+		}
+	}
+
+	int entrants = static_cast<int>(config.entrants.size());
+	report.standings.resize(entrants);
+	report.headToHead.assign(entrants, vector<TournamentScore>(entrants));
+	for (int i = 0; i < entrants; ++i) {
+		report.standings[i].bot = config.entrants[i];
+		report.standings[i].byVariant.resize(report.variants.size());
+	}
+
+	//Variant, then pair, then game; the first move alternates inside each pairing
+	vector<Fixture> schedule;
+	for (int v = 0; v < static_cast<int>(report.variants.size()); ++v) {
+		for (int i = 0; i < entrants; ++i) {
+			for (int j = i + 1; j < entrants; ++j) {
+				for (int g = 0; g < gamesPerPairing; ++g) {
+					bool rowFirst = (g % 2 == 0);
+					schedule.push_back(Fixture{ { rowFirst ? i : j, rowFirst ? j : i }, v, rowFirst });
+				}
+			}
+		}
+	}
+
+	ThreadPool pool(config.threads);
+	report.threadsUsed = pool.size();
+	vector<FixtureResult> results(schedule.size());
+	auto start = chrono::steady_clock::now();
+
+	pool.parallelFor(static_cast<int>(schedule.size()), [&](int index) {
+		const Fixture& f = schedule[index];
+		TournamentVariant variant = report.variants[f.variant];
+		pair<Archetype, Archetype> archs = variantArchetypes(variant);
+
+		//Same turn loop, digest and Rng streams as self-play, game index = schedule index
+		SelfPlayConfig game;
+		game.mode = isBattle(variant) ? SelfPlayMode::Battle : SelfPlayMode::Regular;
+		game.seed = config.seed;
+		game.turnLimit = config.turnLimit;
+		game.searchDepth = config.searchDepth;
+		game.bots[0] = config.entrants[f.entrants[0]];
+		game.bots[1] = config.entrants[f.entrants[1]];
+		game.archetypes[0] = f.rowFirst ? archs.first : archs.second;
+		game.archetypes[1] = f.rowFirst ? archs.second : archs.first;
+
+		GameRecord record = playSelfPlayGame(game, index);
+		results[index].outcome = record.outcome;
+		results[index].digest = record.digest;
+	});
+
+	report.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	report.games = static_cast<int>(schedule.size());
+
+	report.digest = fnvOffset;
+	for (size_t k = 0; k < schedule.size(); ++k) {
+		const Fixture& f = schedule[k];
+		const GameOutcome& outcome = results[k].outcome;
+		if (outcome.turnLimitHit) report.turnLimitHits++;
+		report.digest = fnvFold(report.digest, results[k].digest);
+
+		for (int seat = 0; seat < 2; ++seat) {
+			int self = f.entrants[seat], other = f.entrants[seat ^ 1];
+			int result = (outcome.winnerSeat == -1) ? 0 : (outcome.winnerSeat == seat) ? 1 : -1;
+			//Variants are named from the lower entrant's side, flip AP/PA for the other one
+			int variant = (self < other) ? f.variant : mirroredVariant(report.variants, f.variant);
+
+			addResult(report.standings[self].total, result);
+			addResult(report.standings[self].byVariant[variant], result);
+			addResult(report.headToHead[self][other], result);
+		}
+	}
+
+	if (entrants > 1) fitRatings(report);
+	return report;
+}
+
+
+// ------------- Report -------------
+
+void printTournamentReport(ostream& out, const TournamentReport& report) {
+	const TournamentConfig& c = report.config;
+	auto pct = [](const TournamentScore& s) { return s.games() ? 100.0 * s.points() / s.games() : 0.0; };
+
+	out << "Tournament: " << c.entrants.size() << " entrants, " << report.variants.size() << " variants, "
+		<< c.gamesPerPairing << " games per pairing, seed " << c.seed << ", " << report.threadsUsed << " threads\n";
+	out << fixed << setprecision(2) << "  " << report.games << " games in " << report.seconds << "s, "
+		<< setprecision(0) << (report.seconds > 0 ? report.games / report.seconds : 0.0) << " games/s";
+	if (report.turnLimitHits) out << ", " << report.turnLimitHits << " hit the turn limit";
+	out << "\n  Digest " << hex << setw(16) << setfill('0') << report.digest << dec << setfill(' ') << "\n";
+
+	vector<int> order(report.standings.size());
+	iota(order.begin(), order.end(), 0);
+	stable_sort(order.begin(), order.end(), [&](int a, int b) { return report.standings[a].elo > report.standings[b].elo; });
+
+	out << "\n  Rank  Entrant      Elo   95% CI    Games      W      L      T   Score\n";
+	for (size_t rank = 0; rank < order.size(); ++rank) {
+		const TournamentStanding& s = report.standings[order[rank]];
+		out << "  " << setw(4) << rank + 1 << "  " << left << setw(9) << botName(s.bot) << right
+			<< setprecision(0) << setw(7) << s.elo << "  +/-" << setw(4) << s.eloMargin
+			<< setw(9) << s.total.games() << setw(7) << s.total.wins << setw(7) << s.total.losses << setw(7) << s.total.ties
+			<< setprecision(1) << setw(7) << pct(s.total) << "%\n";
+	}
+
+	out << "\n  Score by variant (first letter is the entrant's archetype)\n  " << left << setw(9) << "" << right;
+	for (TournamentVariant v : report.variants) out << setw(11) << variantName(v);
+	out << "\n";
+	for (int i : order) {
+		const TournamentStanding& s = report.standings[i];
+		out << "  " << left << setw(9) << botName(s.bot) << right;
+		for (const TournamentScore& score : s.byVariant) out << setw(10) << pct(score) << "%";
+		out << "\n";
+	}
+
+	out << "\n  Head to head (row's score)\n  " << left << setw(9) << "" << right;
+	for (int j : order) out << setw(9) << botName(report.standings[j].bot);
+	out << "\n";
+	for (int i : order) {
+		out << "  " << left << setw(9) << botName(report.standings[i].bot) << right;
+		for (int j : order) {
+			if (i == j) out << setw(9) << "-";
+			else out << setw(8) << pct(report.headToHead[i][j]) << "%";
+		}
+		out << "\n";
+	}
+}
+
+int runTournamentCommand(int argc, char* argv[]) {
+	TournamentConfig config;
+	auto usage = [](const string& problem) {
+		cerr << problem << "\n"
+			<< "Usage: --tournament [even games per pairing] [--entrants random,greedy,perfect,search,mcts] [--modes regular,battle]\n"
+			<< "       [--seed N] [--threads N] [--turn-limit N] [--depth N]\n";
+		return 1;
+	};
+
+	for (int i = 0; i < argc; ++i) {
+		string arg = argv[i];
+		string value = (i + 1 < argc) ? argv[i + 1] : "";
+
+		if (arg == "--entrants" && !value.empty()) {
+			config.entrants.clear();
+			istringstream names(value);
+			for (string name; getline(names, name, ',');) {
+				BotKind kind;
+				if (!parseBotKind(name, kind)) return usage("Unknown strategy: " + name);
+				config.entrants.push_back(kind);
+			}
+			++i;
+		}
+		else if (arg == "--modes" && !value.empty()) {
+			config.regular = value.find("regular") != string::npos;
+			config.battle = value.find("battle") != string::npos;
+			++i;
+		}
+		else if (arg == "--seed" && !value.empty()) {
+			if (!parseUint64(value, config.seed)) return usage("Invalid seed: " + value);
+			++i;
+		}
+		else if (arg == "--threads" && !value.empty()) {
+			if (!parseInt(value, config.threads, 0)) return usage("Invalid thread count: " + value);
+			++i;
+		}
+		else if (arg == "--turn-limit" && !value.empty()) {
+			if (!parseInt(value, config.turnLimit, 0)) return usage("Invalid turn limit: " + value);
+			++i;
+		}
+		else if (arg == "--depth" && !value.empty()) {
+			if (!parseInt(value, config.searchDepth, 1, 64)) return usage("Invalid depth: " + value);
+			++i;
+		}
+		else if (!arg.empty() && isdigit(static_cast<unsigned char>(arg[0]))) {
+			if (!parseInt(arg, config.gamesPerPairing, 1)) return usage("Invalid game count: " + arg);
+			if (config.gamesPerPairing % 2) return usage("Games per pairing must be even, so both entrants move first equally often: " + arg);
+		}
+		else {
+			return usage("Unknown option: " + arg);
+		}
+	}
+
+	if (config.entrants.size() < 2 || (!config.regular && !config.battle)) {
+		cerr << "A tournament needs at least two entrants and one mode.\n";
+		return 1;
+	}
+
+	printTournamentReport(cout, runTournament(config));
+	return 0;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "SelfPlay.h"
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+
+// ------------- Tournament -------------
+
+// Round-robin between bot strategies. Every pair meets in each variant
+// (Regular, and Battle with every Alchemist/Paladin pairing), swapping who
+// moves first from game to game. Games run on the work-stealing pool, each
+// from its own Rng streams, so the tables don't depend on the thread count.
+// Ratings are a Bradley-Terry fit over all games (a tie is half a win for
+// both sides), reported on the Elo scale around an average of 1500.
+
+enum class TournamentVariant {
+	Regular,
+	BattleAA,	//Alchemist vs Alchemist; first letter is the row entrant's archetype
+	BattleAP,
+	BattlePA,
+	BattlePP
+};
+
+const char* variantName(TournamentVariant variant);
+
+struct TournamentConfig {
+	std::vector<BotKind> entrants = { BotKind::Random, BotKind::Greedy, BotKind::Perfect, BotKind::Search, BotKind::Mcts };
+	bool regular = true;
+	bool battle = true;
+	int gamesPerPairing = 40;	//Per pair and variant, split evenly between first and second player (odd counts round up)
+	uint64_t seed = 1;
+	int threads = 0;			//0 = one per core
+	int turnLimit = 200;		//Battle games past this are Ties
+	int searchDepth = 4;
+};
+
+struct TournamentScore {
+	int wins = 0;
+	int losses = 0;
+	int ties = 0;
+
+	int games() const { return wins + losses + ties; }
+	double points() const { return wins + 0.5 * ties; }
+};
+
+struct TournamentStanding {
+	BotKind bot = BotKind::Random;
+	double elo = 1500.0;
+	double eloMargin = 0.0;		//95% interval is elo +- eloMargin
+	TournamentScore total;
+	std::vector<TournamentScore> byVariant;		//Indexed like TournamentReport::variants
+};
+
+struct TournamentReport {
+	TournamentConfig config;
+	std::vector<TournamentVariant> variants;
+	std::vector<TournamentStanding> standings;				//In entrant order; printTournamentReport sorts by Elo
+	std::vector<std::vector<TournamentScore>> headToHead;	//[row][column], the row entrant's results
+	int games = 0;
+	int turnLimitHits = 0;
+	uint64_t digest = 0;	//All game digests folded in schedule order
+	int threadsUsed = 0;
+	double seconds = 0.0;
+};
+
+TournamentReport runTournament(const TournamentConfig& config);
+void printTournamentReport(std::ostream& out, const TournamentReport& report);
+
+//Entry point for "--tournament [games] [options]"
+int runTournamentCommand(int argc, char* argv[]);